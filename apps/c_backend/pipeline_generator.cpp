@@ -13,12 +13,15 @@ public:
     void generate() {
         Var x, y;
 
-        Func f, h;
+        Func f, g, h;
         f(x, y) = (input(clamp(x + 2, 0, input.dim(0).extent() - 1), clamp(y - 2, 0, input.dim(1).extent() - 1)) * 17) / 13;
+        // A saturating add, which the C backend does with native vector ops.
+        g(x, y) = cast<uint16_t>(min(cast<uint32_t>(f(x, y)) + f(x + 1, y), 65535));
         h.define_extern("an_extern_stage", {f}, Int(16), 0, NameMangling::C);
-        output(x, y) = cast<uint16_t>(max(0, f(y, x) + f(x, y) + an_extern_func(x, y) + h()));
+        output(x, y) = cast<uint16_t>(max(0, f(y, x) + g(x, y) + an_extern_func(x, y) + h()));
 
         f.compute_root().vectorize(x, 8);
+        g.compute_root().vectorize(x, 8);
         h.compute_root();
     }
 };
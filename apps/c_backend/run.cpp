@@ -3,6 +3,7 @@
 #include <cstdlib>
 
 #include "HalideBuffer.h"
+#include "halide_benchmark.h"
 #include "pipeline_c.h"
 #include "pipeline_native.h"
 
@@ -48,9 +49,15 @@ int main(int argc, char **argv) {
     Buffer<uint16_t> out_native(423, 633);
     Buffer<uint16_t> out_c(423, 633);
 
-    pipeline_native(in, out_native);
+    double t_native = Halide::Tools::benchmark(10, 10, [&]() {
+        pipeline_native(in, out_native);
+    });
 
-    pipeline_c(in, out_c);
+    double t_c = Halide::Tools::benchmark(10, 10, [&]() {
+        pipeline_c(in, out_c);
+    });
+
+    printf("Native: %gms, C: %gms\n", t_native * 1e3, t_c * 1e3);
 
     for (int y = 0; y < out_native.height(); y++) {
         for (int x = 0; x < out_native.width(); x++) {
@@ -21,7 +21,8 @@ int get_register_count(const Target &target) {
 int get_vector_reduction_factor(const Target &target, Type t) {
     if (target.arch == Target::Hexagon ||
         target.has_feature(Target::ARMDotProd) ||
-        target.has_feature(Target::AVX512_SapphireRapids)) {
+        target.has_feature(Target::AVX512_SapphireRapids) ||
+        target.has_feature(Target::AVXVNNI)) {
         return 32 / t.bits();
     }
 
@@ -16,7 +16,8 @@ Var ci("ci"), co("co");
 // without widening 8-bit multiplication, it's faster to just subtract the
 // offsets and use 16-bit multiplications.
 bool use_8bit_multiply(const Target &target) {
-    return target.arch != Target::X86 || target.has_feature(Target::AVX512_SapphireRapids);
+    return target.arch != Target::X86 ||
+           target.features_any_of({Target::AVX512_SapphireRapids, Target::AVXVNNI});
 }
 
 // How many registers to use as accumulators, as a function of the target.
@@ -154,6 +154,10 @@ void define_enums(py::module &m) {
         .value("LLVMLargeCodeModel", Target::Feature::LLVMLargeCodeModel)
         .value("RVV", Target::Feature::RVV)
         .value("ARMv81a", Target::Feature::ARMv81a)
+        .value("AutoPrefetch", Target::Feature::AutoPrefetch)
+        .value("SpecializeDenseBuffers", Target::Feature::SpecializeDenseBuffers)
+        .value("AVXVNNI", Target::Feature::AVXVNNI)
+        .value("Multiversion", Target::Feature::Multiversion)
         .value("FeatureEnd", Target::Feature::FeatureEnd);
 
     py::enum_<halide_type_code_t>(m, "TypeCode")
@@ -40,6 +40,8 @@ void define_rdom(py::module &m) {
             .def("dimensions", &RDom::dimensions)
             .def("__len__", &RDom::dimensions)
             .def("where", &RDom::where, py::arg("predicate"))
+            .def_static("ragged", (RDom(*)(const Buffer<> &, const std::string &))RDom::ragged, py::arg("offsets"), py::arg("name") = "")
+            .def_static("ragged", (RDom(*)(const ImageParam &, const std::string &))RDom::ragged, py::arg("offsets"), py::arg("name") = "")
             .def("__getitem__", [](RDom &r, const int i) -> RVar {
                 if (i < 0 || i >= r.dimensions()) {
                     throw pybind11::key_error();
@@ -32,6 +32,7 @@ void define_target(py::module &m) {
             .def_readwrite("os", &Target::os)
             .def_readwrite("arch", &Target::arch)
             .def_readwrite("bits", &Target::bits)
+            .def_readwrite("vector_bits", &Target::vector_bits)
 
             .def("__repr__", &target_repr)
             .def("__str__", &Target::to_string)
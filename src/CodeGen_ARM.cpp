@@ -57,6 +57,9 @@ protected:
     void visit(const LE *) override;
     void codegen_vector_reduce(const VectorReduce *, const Expr &) override;
     // @}
+
+    /** Store a vector to scattered addresses using SVE. */
+    void codegen_sve_scatter(const Store *);
     Type upgrade_type_for_arithmetic(const Type &t) const override;
     Type upgrade_type_for_argument_passing(const Type &t) const override;
     Type upgrade_type_for_storage(const Type &t) const override;
@@ -82,6 +85,42 @@ protected:
         return target.has_feature(Target::NoNEON);
     }
 
+    /** The width of the SVE registers if we know it, or zero. */
+    int sve_vector_bits() const {
+        if (target.bits == 64 &&
+            (target.has_feature(Target::SVE) || target.has_feature(Target::SVE2))) {
+            return target.vector_bits;
+        }
+        return 0;
+    }
+
+    /** SVE can gather and scatter vectors of 32 and 64-bit elements. */
+    bool use_sve_gather_scatter(const Type &t) const {
+        return sve_vector_bits() != 0 && t.is_vector() && (t.bits() == 32 || t.bits() == 64);
+    }
+
+    /** Generate a vector of pointers to the elements of a buffer at the
+     * given vector of indices, for a gather or scatter. */
+    Value *codegen_vector_of_pointers(const string &name, const Type &t, const Expr &index);
+
+    /** With SVE, do loads and stores of the first few lanes of a vector
+     * with a whilelt predicate and the SVE ld1 and st1 intrinsics. LLVM
+     * doesn't lower the generic masked intrinsics on fixed-width
+     * vectors to SVE. */
+    // @{
+    Instruction *codegen_active_lanes_load(llvm::Type *type, Value *ptr, int alignment, Value *active_lanes) override;
+    Instruction *codegen_active_lanes_store(Value *val, Value *ptr, int alignment, Value *active_lanes) override;
+    // @}
+
+    /** The scalable vector type that holds a fixed vector of the given
+     * llvm type in one SVE register, and the suffix that names it in
+     * the SVE intrinsics, or nullptr if there isn't one. */
+    llvm::ScalableVectorType *sve_type_of(llvm::Type *fixed_type, string *suffix) const;
+
+    /** Make an SVE predicate with the first active_lanes of the given
+     * number of lanes true. */
+    Value *sve_active_lane_mask(Value *active_lanes, int lanes, llvm::ScalableVectorType *sve_type);
+
     bool is_float16_and_has_feature(const Type &t) const {
         // NOTE : t.is_float() returns true even in case of BFloat16. We don't include it for now.
         return t.code() == Type::Float && t.bits() == 16 && target.has_feature(Target::ARMFp16);
@@ -921,6 +960,90 @@ void CodeGen_ARM::visit(const Max *op) {
     CodeGen_Posix::visit(op);
 }
 
+Value *CodeGen_ARM::codegen_vector_of_pointers(const string &name, const Type &t, const Expr &index) {
+    Value *base = codegen_buffer_pointer(name, t.element_of(), make_zero(Int(32)));
+    Value *offsets = codegen(index);
+    offsets = builder->CreateIntCast(offsets, get_vector_type(i64_t, t.lanes()), true);
+    return builder->CreateInBoundsGEP(llvm_type_of(t.element_of()), base, offsets);
+}
+
+void CodeGen_ARM::codegen_sve_scatter(const Store *op) {
+    Value *val = codegen(op->value);
+    Value *ptrs = codegen_vector_of_pointers(op->name, op->value.type(), op->index);
+    Instruction *store = builder->CreateMaskedScatter(val, ptrs, llvm::Align(op->value.type().bytes()));
+    add_tbaa_metadata(store, op->name, op->index);
+}
+
+llvm::ScalableVectorType *CodeGen_ARM::sve_type_of(llvm::Type *fixed_type, string *suffix) const {
+#if LLVM_VERSION >= 130
+    if (sve_vector_bits() == 0 || !fixed_type->isVectorTy()) {
+        return nullptr;
+    }
+    llvm::Type *elem_t = fixed_type->getScalarType();
+    const int bits = elem_t->getPrimitiveSizeInBits();
+    if (bits * get_vector_num_elements(fixed_type) != sve_vector_bits()) {
+        return nullptr;
+    }
+    ostringstream name;
+    name << "nxv" << 128 / bits;
+    if (elem_t->isIntegerTy(8) || elem_t->isIntegerTy(16) ||
+        elem_t->isIntegerTy(32) || elem_t->isIntegerTy(64)) {
+        name << "i" << bits;
+    } else if (elem_t->isHalfTy() || elem_t->isFloatTy() || elem_t->isDoubleTy()) {
+        name << "f" << bits;
+    } else {
+        return nullptr;
+    }
+    *suffix = name.str();
+    return llvm::ScalableVectorType::get(elem_t, 128 / bits);
+#else
+    // We don't tell older LLVMs how wide the SVE registers are.
+    return nullptr;
+#endif
+}
+
+Value *CodeGen_ARM::sve_active_lane_mask(Value *active_lanes, int lanes, llvm::ScalableVectorType *sve_type) {
+    // The SVE register may have more lanes than we asked for if the
+    // target's vector_bits is wrong, so don't let any more lanes than
+    // that be active.
+    Value *max_lanes = ConstantInt::get(i32_t, lanes);
+    Value *n = builder->CreateSelect(builder->CreateICmpSGT(active_lanes, max_lanes), max_lanes, active_lanes);
+    llvm::Type *pred_t = llvm::ScalableVectorType::get(i1_t, sve_type->getMinNumElements());
+    string pred_suffix = "nxv" + std::to_string(sve_type->getMinNumElements()) + "i1";
+    llvm::Function *whilelt = get_llvm_intrin(pred_t, "llvm.aarch64.sve.whilelt." + pred_suffix + ".i32", {i32_t, i32_t});
+    return builder->CreateCall(whilelt, {ConstantInt::get(i32_t, 0), n});
+}
+
+Instruction *CodeGen_ARM::codegen_active_lanes_load(llvm::Type *type, Value *ptr, int alignment, Value *active_lanes) {
+    string suffix;
+    llvm::ScalableVectorType *sve_type = sve_type_of(type, &suffix);
+    if (!sve_type) {
+        return CodeGen_Posix::codegen_active_lanes_load(type, ptr, alignment, active_lanes);
+    }
+    Value *pred = sve_active_lane_mask(active_lanes, get_vector_num_elements(type), sve_type);
+    llvm::Type *elem_ptr_t = sve_type->getElementType()->getPointerTo();
+    llvm::Function *ld1 = get_llvm_intrin(sve_type, "llvm.aarch64.sve.ld1." + suffix, {pred->getType(), elem_ptr_t});
+    Value *loaded = builder->CreateCall(ld1, {pred, builder->CreatePointerCast(ptr, elem_ptr_t)});
+    llvm::Function *extract = llvm::Intrinsic::getDeclaration(
+        module.get(), llvm::Intrinsic::experimental_vector_extract, {type, sve_type});
+    return builder->CreateCall(extract, {loaded, ConstantInt::get(i64_t, 0)});
+}
+
+Instruction *CodeGen_ARM::codegen_active_lanes_store(Value *val, Value *ptr, int alignment, Value *active_lanes) {
+    string suffix;
+    llvm::ScalableVectorType *sve_type = sve_type_of(val->getType(), &suffix);
+    if (!sve_type) {
+        return CodeGen_Posix::codegen_active_lanes_store(val, ptr, alignment, active_lanes);
+    }
+    Value *pred = sve_active_lane_mask(active_lanes, get_vector_num_elements(val->getType()), sve_type);
+    llvm::Function *insert = llvm::Intrinsic::getDeclaration(
+        module.get(), llvm::Intrinsic::experimental_vector_insert, {sve_type, val->getType()});
+    Value *sv = builder->CreateCall(insert, {UndefValue::get(sve_type), val, ConstantInt::get(i64_t, 0)});
+    llvm::Type *elem_ptr_t = sve_type->getElementType()->getPointerTo();
+    llvm::Function *st1 = get_llvm_intrin(void_t, "llvm.aarch64.sve.st1." + suffix, {sve_type, pred->getType(), elem_ptr_t});
+    return builder->CreateCall(st1, {sv, pred, builder->CreatePointerCast(ptr, elem_ptr_t)});
+}
+
 void CodeGen_ARM::visit(const Store *op) {
     // Predicated store
     if (!is_const_one(op->predicate)) {
@@ -936,6 +1059,12 @@ void CodeGen_ARM::visit(const Store *op) {
     // A dense store of an interleaving can be done using a vst2 intrinsic
     const Ramp *ramp = op->index.as<Ramp>();
 
+    // Scattered stores can use SVE scatters
+    if (!ramp && use_sve_gather_scatter(op->value.type())) {
+        codegen_sve_scatter(op);
+        return;
+    }
+
     // We only deal with ramps here
     if (!ramp) {
         CodeGen_Posix::visit(op);
@@ -1073,6 +1202,12 @@ void CodeGen_ARM::visit(const Store *op) {
         return;
     }
 
+    // Other strided stores can use SVE scatters
+    if (use_sve_gather_scatter(op->value.type())) {
+        codegen_sve_scatter(op);
+        return;
+    }
+
     // We have builtins for strided stores with fixed but unknown stride, but they use inline assembly
     if (target.bits != 64 /* Not yet implemented for aarch64 */) {
         ostringstream builtin;
@@ -1112,15 +1247,29 @@ void CodeGen_ARM::visit(const Load *op) {
 
     const Ramp *ramp = op->index.as<Ramp>();
 
-    // We only deal with ramps here
-    if (!ramp) {
+    // If the stride is in [-1, 4], we can deal with that using vanilla codegen
+    const IntImm *stride = ramp ? ramp->stride.as<IntImm>() : nullptr;
+    if (stride && (-1 <= stride->value && stride->value <= 4)) {
         CodeGen_Posix::visit(op);
         return;
     }
 
-    // If the stride is in [-1, 4], we can deal with that using vanilla codegen
-    const IntImm *stride = ramp ? ramp->stride.as<IntImm>() : nullptr;
-    if (stride && (-1 <= stride->value && stride->value <= 4)) {
+    // Anything else can use an SVE gather
+    if (use_sve_gather_scatter(op->type)) {
+        Value *ptrs = codegen_vector_of_pointers(op->name, op->type, op->index);
+        llvm::Align align(op->type.bytes());
+#if LLVM_VERSION >= 130
+        Instruction *load = builder->CreateMaskedGather(llvm_type_of(op->type), ptrs, align);
+#else
+        Instruction *load = builder->CreateMaskedGather(ptrs, align);
+#endif
+        add_tbaa_metadata(load, op->name, op->index);
+        value = load;
+        return;
+    }
+
+    // We only deal with ramps here
+    if (!ramp) {
         CodeGen_Posix::visit(op);
         return;
     }
@@ -1466,6 +1615,9 @@ bool CodeGen_ARM::use_soft_float_abi() const {
 }
 
 int CodeGen_ARM::native_vector_bits() const {
+    if (sve_vector_bits() != 0) {
+        return sve_vector_bits();
+    }
     return 128;
 }
 
@@ -67,6 +67,7 @@ const string headers = R"INLINE_CODE(
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <limits>
 #include <type_traits>
 )INLINE_CODE";
 
@@ -190,6 +191,20 @@ inline T halide_cpp_max(const T &a, const T &b) {return (a > b) ? a : b;}
 template<typename T>
 inline T halide_cpp_min(const T &a, const T &b) {return (a < b) ? a : b;}
 
+template<typename T>
+inline T halide_cpp_saturating_add(const T &a, const T &b) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4, "halide_cpp_saturating_add() requires an integer of 32 bits or less");
+    const int64_t r = (int64_t)a + (int64_t)b;
+    return (T)halide_cpp_min<int64_t>(halide_cpp_max<int64_t>(r, std::numeric_limits<T>::min()), std::numeric_limits<T>::max());
+}
+
+template<typename T>
+inline T halide_cpp_saturating_sub(const T &a, const T &b) {
+    static_assert(std::is_integral<T>::value && sizeof(T) <= 4, "halide_cpp_saturating_sub() requires an integer of 32 bits or less");
+    const int64_t r = (int64_t)a - (int64_t)b;
+    return (T)halide_cpp_min<int64_t>(halide_cpp_max<int64_t>(r, std::numeric_limits<T>::min()), std::numeric_limits<T>::max());
+}
+
 template<typename T>
 inline void halide_unused(const T&) {}
 
@@ -550,6 +565,14 @@ public:
         return r;
     }
 
+    template<typename InputVec, int... Indices>
+    static Vec shuffle2(const InputVec &a, const InputVec &b) {
+        static_assert(sizeof...(Indices) == Lanes, "shuffle2() requires an exact match of lanes");
+        constexpr int input_lanes = sizeof(InputVec) / sizeof(ElementType);
+        Vec r = { (Indices < input_lanes ? a[Indices >= 0 && Indices < input_lanes ? Indices : 0] : b[Indices >= input_lanes ? Indices - input_lanes : 0])... };
+        return r;
+    }
+
     static Vec replace(const Vec &v, size_t i, const ElementType b) {
         Vec r = v;
         r[i] = b;
@@ -581,6 +604,22 @@ public:
         return r;
     }
 
+    static Vec saturating_add(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_add(a[i], b[i]);
+        }
+        return r;
+    }
+
+    static Vec saturating_sub(const Vec &a, const Vec &b) {
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_sub(a[i], b[i]);
+        }
+        return r;
+    }
+
     static Vec select(const Mask &cond, const Vec &true_value, const Vec &false_value) {
         Vec r;
         for (size_t i = 0; i < Lanes; i++) {
@@ -1091,6 +1130,23 @@ public:
 #endif
     }
 
+    template<typename InputVec, int... Indices>
+    static Vec shuffle2(const InputVec a, const InputVec b) {
+        static_assert(sizeof...(Indices) == Lanes, "shuffle2() requires an exact match of lanes");
+#if __has_builtin(__builtin_shufflevector)
+        // Clang
+        return __builtin_shufflevector(a, b, Indices...);
+#else
+        // GCC's __builtin_shuffle can't change the number of lanes. Native
+        // vectors are only used for powers of two lanes with GCC, so the
+        // vectors have no padding. The subscripts of the arm not taken
+        // are clamped too, or GCC warns that they are out of bounds.
+        constexpr int input_lanes = sizeof(InputVec) / sizeof(ElementType);
+        Vec r = { (Indices < input_lanes ? a[Indices >= 0 && Indices < input_lanes ? Indices : 0] : b[Indices >= input_lanes ? Indices - input_lanes : 0])... };
+        return r;
+#endif
+    }
+
     static Vec replace(Vec v, size_t i, const ElementType b) {
         v[i] = b;
         return v;
@@ -1146,6 +1202,40 @@ public:
 #endif
     }
 
+    static Vec saturating_add(const Vec a, const Vec b) {
+#if __has_builtin(__builtin_elementwise_add_sat)
+        return __builtin_elementwise_add_sat(a, b);
+#else
+        if (std::is_unsigned<ElementType>::value) {
+            // The sum wrapped around if it is less than an operand.
+            const Vec r = a + b;
+            return r | (Vec)(r < a);
+        }
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_add(a[i], b[i]);
+        }
+        return r;
+#endif
+    }
+
+    static Vec saturating_sub(const Vec a, const Vec b) {
+#if __has_builtin(__builtin_elementwise_sub_sat)
+        return __builtin_elementwise_sub_sat(a, b);
+#else
+        if (std::is_unsigned<ElementType>::value) {
+            // The difference wrapped around if it is greater than a.
+            const Vec r = a - b;
+            return r & (Vec)(r <= a);
+        }
+        Vec r;
+        for (size_t i = 0; i < Lanes; i++) {
+            r[i] = ::halide_cpp_saturating_sub(a[i], b[i]);
+        }
+        return r;
+#endif
+    }
+
     static Vec select(const Mask cond, const Vec true_value, const Vec false_value) {
 #if defined(__GNUC__) && !defined(__clang__)
         // This should do the correct lane-wise select.
@@ -1805,6 +1895,7 @@ void CodeGen_C::compile(const LoweredFunc &f, const std::map<std::string, std::s
     }
 
     const std::vector<LoweredArgument> &args = f.args;
+    current_function_args = args;
 
     have_user_context = false;
     for (const auto &arg : args) {
@@ -2570,12 +2661,31 @@ void CodeGen_C::visit(const Call *op) {
         rhs << "__builtin_prefetch("
             << "((" << print_type(op->type) << " *)" << print_name(base->name)
             << " + " << print_expr(base_offset) << "), /*rw*/0, /*locality*/0)";
+    } else if (op->is_intrinsic(Call::call_cached_indirect_function)) {
+        // There's no runtime dispatch in C, so call the final
+        // sub-function, which works everywhere, with our arguments.
+        internal_assert(op->args.size() >= 4 && !(op->args.size() & 1));
+        const StringImm *fn = op->args.back().as<StringImm>();
+        internal_assert(fn);
+        vector<string> call_args;
+        for (const auto &arg : current_function_args) {
+            call_args.push_back(print_name(arg.name) + (arg.is_buffer() ? "_buffer" : ""));
+        }
+        rhs << c_print_name(fn->value, false) << "(" << with_commas(call_args) << ")";
     } else if (op->is_intrinsic(Call::size_of_halide_buffer_t)) {
         rhs << "(sizeof(halide_buffer_t))";
     } else if (op->is_intrinsic(Call::strict_float)) {
         internal_assert(op->args.size() == 1);
         string arg0 = print_expr(op->args[0]);
         rhs << "(" << arg0 << ")";
+    } else if ((op->is_intrinsic(Call::saturating_add) || op->is_intrinsic(Call::saturating_sub)) &&
+               op->type.is_vector() && op->type.bits() <= 32) {
+        // Native vectors have builtins for these, which are much faster
+        // than the widening and narrowing of lower_intrinsic.
+        internal_assert(op->args.size() == 2);
+        string a0 = print_expr(op->args[0]);
+        string a1 = print_expr(op->args[1]);
+        rhs << print_type(op->type) << "_ops::" << op->name << "(" << a0 << ", " << a1 << ")";
     } else if (op->is_intrinsic()) {
         Expr lowered = lower_intrinsic(op);
         if (lowered.defined()) {
@@ -3191,7 +3301,16 @@ void CodeGen_C::visit(const Shuffle *op) {
     } else {
         internal_assert(op->vectors[0].type().is_vector());
         string src = vecs[0];
-        if (op->vectors.size() > 1) {
+        if (op->vectors.size() == 2) {
+            // Shuffle the two vectors directly, which native vectors can do
+            // in one instruction.
+            const Type t0 = op->vectors[0].type();
+            internal_assert(t0 == op->vectors[1].type());
+            rhs << print_type(op->type) << "_ops::shuffle2<" << print_type(t0) << ", " << with_commas(op->indices) << ">("
+                << vecs[0] << ", " << vecs[1] << ")";
+            print_assignment(op->type, rhs.str());
+            return;
+        } else if (op->vectors.size() > 1) {
             // This code has always assumed/required that all the vectors
             // have identical types, so let's verify
             const Type t0 = op->vectors[0].type();
@@ -173,6 +173,9 @@ protected:
     /** True if there is a void * __user_context parameter in the arguments. */
     bool have_user_context;
 
+    /** The arguments of the function being compiled. */
+    std::vector<LoweredArgument> current_function_args;
+
     /** Track current calling convention scope. */
     bool extern_c_open;
 
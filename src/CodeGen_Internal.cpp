@@ -685,6 +685,22 @@ void set_function_attributes_for_target(llvm::Function *fn, const Target &t) {
     // Turn off approximate reciprocals for division. It's too
     // inaccurate even for us.
     fn->addFnAttr("reciprocal-estimates", "none");
+
+#if LLVM_VERSION >= 130
+    // Tell LLVM how wide the SVE registers are, so that it can use them
+    // for fixed-width vectors wider than NEON.
+    if (t.arch == Target::ARM && t.bits == 64 && t.vector_bits != 0 &&
+        (t.has_feature(Target::SVE) || t.has_feature(Target::SVE2))) {
+        const unsigned vscale = t.vector_bits / 128;
+        fn->addFnAttr(llvm::Attribute::getWithVScaleRangeArgs(fn->getContext(), vscale, vscale));
+    }
+    // Likewise for RVV, which has 64-bit blocks. CodeGen_RISCV assumes
+    // the minimum VLEN of the V extension if the target doesn't say.
+    if (t.arch == Target::RISCV && t.has_feature(Target::RVV)) {
+        const unsigned vscale = (t.vector_bits != 0 ? t.vector_bits : 128) / 64;
+        fn->addFnAttr(llvm::Attribute::getWithVScaleRangeArgs(fn->getContext(), vscale, vscale));
+    }
+#endif
 }
 
 void embed_bitcode(llvm::Module *M, const string &halide_command) {
@@ -338,6 +338,10 @@ void CodeGen_LLVM::init_module() {
     module = get_initial_module_for_target(target, context);
 }
 
+void CodeGen_LLVM::set_target(const Target &t) {
+    target = t;
+}
+
 void CodeGen_LLVM::add_external_code(const Module &halide_module) {
     for (const ExternalCode &code_blob : halide_module.external_code()) {
         if (code_blob.is_for_cpu_target(get_target())) {
@@ -524,6 +528,17 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
         FunctionType *func_t = FunctionType::get(i32_t, arg_types, false);
         function = llvm::Function::Create(func_t, llvm_linkage(f.linkage), names.extern_name, module.get());
         set_function_attributes_for_target(function, target);
+        if (!f.extra_features.empty()) {
+            // LLVM picks the subtarget per function, so tell it about the
+            // extra features.
+            const Target module_target = target;
+            Target function_target = target;
+            function_target.set_features(f.extra_features);
+            set_target(function_target);
+            function->addFnAttr("target-cpu", mcpu());
+            function->addFnAttr("target-features", mattrs());
+            set_target(module_target);
+        }
 
         // Mark the buffer args as no alias
         for (size_t i = 0; i < f.args.size(); i++) {
@@ -554,9 +569,18 @@ std::unique_ptr<llvm::Module> CodeGen_LLVM::compile(const Module &input) {
     for (const auto &f : input.functions()) {
         const auto names = function_names[idx++];
 
+        const Target module_target = target;
+        if (!f.extra_features.empty()) {
+            Target function_target = target;
+            function_target.set_features(f.extra_features);
+            set_target(function_target);
+        }
         run_with_large_stack([&]() {
             compile_func(f, names.simple_name, names.extern_name);
         });
+        if (!f.extra_features.empty()) {
+            set_target(module_target);
+        }
     }
 
     debug(2) << "llvm::Module pointer: " << module.get() << "\n";
@@ -1981,15 +2005,7 @@ void CodeGen_LLVM::visit(const Load *op) {
                 Value *load_i = codegen_dense_vector_load(op->type.with_lanes(load_lanes_i), op->name, slice_base,
                                                           op->image, op->param, align, nullptr, false);
 
-                SmallVector<Constant *, 256> constants;
-                for (int j = 0; j < lanes_i; j++) {
-                    Constant *constant = ConstantInt::get(i32_t, j * stride->value + offset);
-                    constants.push_back(constant);
-                }
-                Constant *constantsV = ConstantVector::get(constants);
-                Value *undef = UndefValue::get(load_i->getType());
-                Value *shuffleInstr = builder->CreateShuffleVector(load_i, undef, constantsV);
-                results.push_back(shuffleInstr);
+                results.push_back(deinterleave_vector(load_i, offset, stride->value, lanes_i));
             }
 
             // Concat the results
@@ -2189,11 +2205,106 @@ void CodeGen_LLVM::scalarize(const Expr &e) {
     value = result;
 }
 
+namespace {
+// If a vector predicate is true for the first k lanes and false for the
+// rest, for some k only known at runtime, return k. This is the form of
+// the predicates made by TailStrategy::Predicate. Otherwise return an
+// undefined Expr. The predicate may be a variable bound by one of the
+// given lets.
+Expr active_lanes_of_predicate(Expr pred, const Scope<Expr> &lets) {
+    auto resolve = [&](Expr e) {
+        e = unwrap_tags(e);
+        while (const Variable *v = e.as<Variable>()) {
+            if (!lets.contains(v->name)) {
+                break;
+            }
+            e = unwrap_tags(lets.get(v->name));
+        }
+        return e;
+    };
+
+    pred = resolve(pred);
+    bool negate = false;
+    if (const Not *n = pred.as<Not>()) {
+        pred = resolve(n->a);
+        negate = true;
+    }
+
+    // Rewrite the predicate as a < b, or a <= b if or_equal is set.
+    Expr a, b;
+    bool or_equal = false;
+    if (const LT *lt = pred.as<LT>()) {
+        a = lt->a;
+        b = lt->b;
+    } else if (const LE *le = pred.as<LE>()) {
+        a = le->a;
+        b = le->b;
+        or_equal = true;
+    } else if (const GT *gt = pred.as<GT>()) {
+        a = gt->b;
+        b = gt->a;
+    } else if (const GE *ge = pred.as<GE>()) {
+        a = ge->b;
+        b = ge->a;
+        or_equal = true;
+    } else {
+        return Expr();
+    }
+    if (negate) {
+        std::swap(a, b);
+        or_equal = !or_equal;
+    }
+
+    const Ramp *r = a.as<Ramp>();
+    const Broadcast *bc = b.as<Broadcast>();
+    if (!r || !bc || !is_const_one(r->stride) ||
+        r->base.type() != Int(32) || bc->value.type() != Int(32)) {
+        return Expr();
+    }
+    Expr count = bc->value - r->base;
+    if (or_equal) {
+        count += 1;
+    }
+    return simplify(count);
+}
+}  // namespace
+
+Value *CodeGen_LLVM::active_lane_mask(Value *active_lanes, int lanes) {
+    vector<Constant *> indices(lanes);
+    for (int i = 0; i < lanes; i++) {
+        indices[i] = ConstantInt::get(i32_t, i);
+    }
+    return builder->CreateICmpSLT(ConstantVector::get(indices), create_broadcast(active_lanes, lanes));
+}
+
+Instruction *CodeGen_LLVM::codegen_active_lanes_load(llvm::Type *type, Value *ptr, int alignment, Value *active_lanes) {
+    Value *mask = active_lane_mask(active_lanes, get_vector_num_elements(type));
+#if LLVM_VERSION >= 130
+    return builder->CreateMaskedLoad(type, ptr, llvm::Align(alignment), mask);
+#else
+    return builder->CreateMaskedLoad(ptr, llvm::Align(alignment), mask);
+#endif
+}
+
+Instruction *CodeGen_LLVM::codegen_active_lanes_store(Value *val, Value *ptr, int alignment, Value *active_lanes) {
+    Value *mask = active_lane_mask(active_lanes, get_vector_num_elements(val->getType()));
+    return builder->CreateMaskedStore(val, ptr, llvm::Align(alignment), mask);
+}
+
 void CodeGen_LLVM::codegen_predicated_store(const Store *op) {
     const Ramp *ramp = op->index.as<Ramp>();
     if (ramp && is_const_one(ramp->stride) && !emit_atomic_stores) {  // Dense vector store
         debug(4) << "Predicated dense vector store\n\t" << Stmt(op) << "\n";
-        Value *vpred = codegen(op->predicate);
+        // If only the first few lanes are stored, as in the tail of a
+        // loop split with TailStrategy::Predicate, the target may have
+        // a cheaper way to make the mask than a vector comparison.
+        Expr active_lanes = active_lanes_of_predicate(op->predicate, vector_predicate_lets);
+        Value *vpred = nullptr, *vactive_lanes = nullptr;
+        if (active_lanes.defined()) {
+            vactive_lanes = codegen(active_lanes);
+        } else {
+            vpred = codegen(op->predicate);
+        }
         Halide::Type value_type = op->value.type();
         Value *val = codegen(op->value);
         int alignment = value_type.bytes();
@@ -2232,9 +2343,14 @@ void CodeGen_LLVM::codegen_predicated_store(const Store *op) {
             Value *elt_ptr = codegen_buffer_pointer(op->name, value_type.element_of(), slice_base);
             Value *vec_ptr = builder->CreatePointerCast(elt_ptr, slice_val->getType()->getPointerTo());
 
-            Value *slice_mask = slice_vector(vpred, i, slice_lanes);
-            Instruction *store =
-                builder->CreateMaskedStore(slice_val, vec_ptr, llvm::Align(alignment), slice_mask);
+            Instruction *store;
+            if (vactive_lanes) {
+                Value *slice_active_lanes = builder->CreateSub(vactive_lanes, ConstantInt::get(i32_t, i));
+                store = codegen_active_lanes_store(slice_val, vec_ptr, alignment, slice_active_lanes);
+            } else {
+                Value *slice_mask = slice_vector(vpred, i, slice_lanes);
+                store = builder->CreateMaskedStore(slice_val, vec_ptr, llvm::Align(alignment), slice_mask);
+            }
             add_tbaa_metadata(store, op->name, slice_index);
         }
     } else {  // It's not dense vector store, we need to scalarize it
@@ -2280,7 +2396,7 @@ void CodeGen_LLVM::codegen_predicated_store(const Store *op) {
 
 llvm::Value *CodeGen_LLVM::codegen_dense_vector_load(const Type &type, const std::string &name, const Expr &base,
                                                      const Buffer<> &image, const Parameter &param, const ModulusRemainder &alignment,
-                                                     llvm::Value *vpred, bool slice_to_native) {
+                                                     llvm::Value *vpred, bool slice_to_native, llvm::Value *active_lanes) {
     debug(4) << "Vectorize predicated dense vector load:\n\t"
              << "(" << type << ")" << name << "[ramp(base, 1, " << type.lanes() << ")]\n";
 
@@ -2329,7 +2445,10 @@ llvm::Value *CodeGen_LLVM::codegen_dense_vector_load(const Type &type, const std
         Value *vec_ptr = builder->CreatePointerCast(elt_ptr, slice_type->getPointerTo());
 
         Instruction *load_inst;
-        if (vpred != nullptr) {
+        if (active_lanes != nullptr) {
+            Value *slice_active_lanes = builder->CreateSub(active_lanes, ConstantInt::get(i32_t, i));
+            load_inst = codegen_active_lanes_load(slice_type, vec_ptr, align_bytes, slice_active_lanes);
+        } else if (vpred != nullptr) {
             Value *slice_mask = slice_vector(vpred, i, slice_lanes);
 #if LLVM_VERSION >= 130
             load_inst = builder->CreateMaskedLoad(slice_type, vec_ptr, llvm::Align(align_bytes), slice_mask);
@@ -2359,8 +2478,14 @@ void CodeGen_LLVM::codegen_predicated_load(const Load *op) {
     const IntImm *stride = ramp ? ramp->stride.as<IntImm>() : nullptr;
 
     if (ramp && is_const_one(ramp->stride)) {  // Dense vector load
-        Value *vpred = codegen(op->predicate);
-        value = codegen_dense_vector_load(op, vpred);
+        Expr active_lanes = active_lanes_of_predicate(op->predicate, vector_predicate_lets);
+        if (active_lanes.defined()) {
+            value = codegen_dense_vector_load(op->type, op->name, ramp->base, op->image, op->param,
+                                              op->alignment, nullptr, true, codegen(active_lanes));
+        } else {
+            Value *vpred = codegen(op->predicate);
+            value = codegen_dense_vector_load(op, vpred);
+        }
     } else if (ramp && stride && stride->value == -1) {
         debug(4) << "Predicated dense vector load with stride -1\n\t" << Expr(op) << "\n";
         vector<int> indices(ramp->lanes);
@@ -3462,12 +3587,16 @@ void CodeGen_LLVM::visit(const Prefetch *op) {
 
 void CodeGen_LLVM::visit(const Let *op) {
     sym_push(op->name, codegen(op->value));
+    ScopedBinding<Expr> bind_predicate(op->value.type().is_bool() && op->value.type().is_vector(),
+                                       vector_predicate_lets, op->name, op->value);
     value = codegen(op->body);
     sym_pop(op->name);
 }
 
 void CodeGen_LLVM::visit(const LetStmt *op) {
     sym_push(op->name, codegen(op->value));
+    ScopedBinding<Expr> bind_predicate(op->value.type().is_bool() && op->value.type().is_vector(),
+                                       vector_predicate_lets, op->name, op->value);
     codegen(op->body);
     sym_pop(op->name);
 }
@@ -4620,6 +4749,17 @@ Value *CodeGen_LLVM::slice_vector(Value *vec, int start, int size) {
     return shuffle_vectors(vec, indices);
 }
 
+Value *CodeGen_LLVM::deinterleave_vector(Value *vec, int offset, int stride, int lanes) {
+    SmallVector<Constant *, 256> constants;
+    for (int j = 0; j < lanes; j++) {
+        Constant *constant = ConstantInt::get(i32_t, j * stride + offset);
+        constants.push_back(constant);
+    }
+    Constant *constantsV = ConstantVector::get(constants);
+    Value *undef = UndefValue::get(vec->getType());
+    return builder->CreateShuffleVector(vec, undef, constantsV);
+}
+
 Value *CodeGen_LLVM::concat_vectors(const vector<Value *> &v) {
     if (v.size() == 1) {
         return v[0];
@@ -152,6 +152,12 @@ protected:
     /** The target we're generating code for */
     Halide::Target target;
 
+    /** Change the target to generate code for, for a function that
+     * is compiled with more features than the module it is in (see
+     * LoweredFunc::extra_features). Subclasses that declare intrinsics
+     * depending on the target redeclare them here. */
+    virtual void set_target(const Target &t);
+
     /** Grab all the context specific internal state. */
     virtual void init_context();
     /** Initialize the CodeGen_LLVM internal state to compile a fresh
@@ -450,6 +456,11 @@ protected:
      * if you ask for more lanes than the vector has. */
     virtual llvm::Value *slice_vector(llvm::Value *vec, int start, int extent);
 
+    /** Take every stride-th lane of an llvm vector, starting at the
+     * given offset, to make a vector with the given number of
+     * lanes. Used to do strided loads as shuffles of dense loads. */
+    virtual llvm::Value *deinterleave_vector(llvm::Value *vec, int offset, int stride, int lanes);
+
     /** Concatenate a bunch of llvm vectors. Must be of the same type. */
     virtual llvm::Value *concat_vectors(const std::vector<llvm::Value *> &);
 
@@ -459,6 +470,25 @@ protected:
     /** Shorthand for shuffling a vector with an undef vector. */
     llvm::Value *shuffle_vectors(llvm::Value *v, const std::vector<int> &indices);
 
+    /** Make a vector of the given number of booleans, in which the
+     * first active_lanes are true and the rest are false. active_lanes
+     * is a scalar int32, and may be negative or greater than
+     * lanes. The default compares a vector of lane indices against
+     * it. Targets with mask registers may have a cheaper way. */
+    virtual llvm::Value *active_lane_mask(llvm::Value *active_lanes, int lanes);
+
+    /** Load or store a dense vector, touching only its first
+     * active_lanes lanes, as in the tail of a loop split with
+     * TailStrategy::Predicate. The default uses the generic masked
+     * load and store intrinsics with active_lane_mask. Returns the
+     * instruction to attach the alias metadata to. */
+    // @{
+    virtual llvm::Instruction *codegen_active_lanes_load(llvm::Type *type, llvm::Value *ptr,
+                                                         int alignment, llvm::Value *active_lanes);
+    virtual llvm::Instruction *codegen_active_lanes_store(llvm::Value *val, llvm::Value *ptr,
+                                                          int alignment, llvm::Value *active_lanes);
+    // @}
+
     /** Go looking for a vector version of a runtime function. Will
      * return the best match. Matches in the following order:
      *
@@ -502,6 +532,11 @@ private:
      * codegen. Use sym_push and sym_pop to access. */
     Scope<llvm::Value *> symbol_table;
 
+    /** The boolean vectors bound by the lets in scope, so that
+     * predicated loads and stores can see the predicates CSE lifted
+     * out of them. */
+    Scope<Expr> vector_predicate_lets;
+
     /** String constants already emitted to the module. Tracked to
      * prevent emitting the same string many times. */
     std::map<std::string, llvm::Constant *> string_constants;
@@ -534,7 +569,8 @@ private:
 
     llvm::Value *codegen_dense_vector_load(const Type &type, const std::string &name, const Expr &base,
                                            const Buffer<> &image, const Parameter &param, const ModulusRemainder &alignment,
-                                           llvm::Value *vpred = nullptr, bool slice_to_native = true);
+                                           llvm::Value *vpred = nullptr, bool slice_to_native = true,
+                                           llvm::Value *active_lanes = nullptr);
     llvm::Value *codegen_dense_vector_load(const Load *load, llvm::Value *vpred = nullptr, bool slice_to_native = true);
 
     virtual void codegen_predicated_load(const Load *op);
@@ -1,9 +1,20 @@
 #include "CodeGen_Posix.h"
 
+#include "ConciseCasts.h"
+#include "Debug.h"
+#include "IRMatch.h"
+#include "IROperator.h"
+#include "LLVM_Headers.h"
+#include "Util.h"
+
 namespace Halide {
 namespace Internal {
 
 using std::string;
+using std::vector;
+
+using namespace Halide::ConciseCasts;
+using namespace llvm;
 
 #if defined(WITH_RISCV)
 
@@ -19,15 +30,362 @@ public:
 protected:
     using CodeGen_Posix::visit;
 
+    void init_module() override;
+
     string mcpu() const override;
     string mattrs() const override;
     string mabi() const override;
     bool use_soft_float_abi() const override;
     int native_vector_bits() const override;
+
+    void visit(const Add *) override;
+    void visit(const Cast *) override;
+    void visit(const Call *) override;
+
+    /** The width of the RVV registers. If the target doesn't say, this
+     * is the minimum required by the V extension. */
+    int vlen() const {
+        return target.vector_bits != 0 ? target.vector_bits : 128;
+    }
+
+    bool rvv_intrinsics_enabled() const {
+        return target.has_feature(Target::RVV);
+    }
+
+    /** Get the scalable vector type that holds a fixed width vector in
+     * the same registers. */
+    llvm::Type *scalable_type_of(const Type &t) const;
+
+    /** Define a function operating on fixed width vectors that calls
+     * an RVV intrinsic, which operates on scalable vectors. */
+    llvm::Function *define_rvv_intrinsic_wrapper(const string &riscv_name, const Type &ret_type,
+                                                 const vector<Type> &arg_types, int flags);
+
+    /** Various patterns to peephole match against */
+    struct Pattern {
+        string intrin;  ///< Name of the intrinsic
+        Expr pattern;   ///< The pattern to match against
+        Pattern() = default;
+        Pattern(const string &intrin, Expr p)
+            : intrin(intrin), pattern(std::move(p)) {
+        }
+    };
+    vector<Pattern> casts;
 };
 
 CodeGen_RISCV::CodeGen_RISCV(const Target &t)
     : CodeGen_Posix(t) {
+    // clang-format off
+    // VNCLIP, VNCLIPU - Saturating narrowing shift right, rounding
+    // according to vxrm.
+    casts.emplace_back("saturating_shift_right_narrow", u8_sat(rounding_shift_right(wild_u16x_, wild_u16_)));
+    casts.emplace_back("saturating_shift_right_narrow", i8_sat(rounding_shift_right(wild_i16x_, wild_u16_)));
+    casts.emplace_back("saturating_shift_right_narrow", u16_sat(rounding_shift_right(wild_u32x_, wild_u32_)));
+    casts.emplace_back("saturating_shift_right_narrow", i16_sat(rounding_shift_right(wild_i32x_, wild_u32_)));
+    casts.emplace_back("saturating_shift_right_narrow", u32_sat(rounding_shift_right(wild_u64x_, wild_u64_)));
+    casts.emplace_back("saturating_shift_right_narrow", i32_sat(rounding_shift_right(wild_i64x_, wild_u64_)));
+
+    // A shift of zero is just a saturating narrow.
+    casts.emplace_back("saturating_narrow", u8_sat(wild_u16x_));
+    casts.emplace_back("saturating_narrow", i8_sat(wild_i16x_));
+    casts.emplace_back("saturating_narrow", u16_sat(wild_u32x_));
+    casts.emplace_back("saturating_narrow", i16_sat(wild_i32x_));
+    casts.emplace_back("saturating_narrow", u32_sat(wild_u64x_));
+    casts.emplace_back("saturating_narrow", i32_sat(wild_i64x_));
+    // clang-format on
+}
+
+constexpr int max_intrinsic_args = 4;
+
+struct RISCVIntrinsic {
+    const char *riscv_name;
+    halide_type_t ret_type;
+    const char *name;
+    halide_type_t arg_types[max_intrinsic_args];
+    int flags;
+    enum {
+        MangleAllArgs = 1 << 0,   // Most intrinsics only mangle the arguments after the first. Some mangle all of them.
+        RoundNearestUp = 1 << 1,  // The result depends on vxrm, which must be round-to-nearest-up.
+    };
+};
+
+// Each intrinsic is listed with 8-bit operands (or 16-bit operands for
+// narrowing ones). Versions for wider elements are generated as well.
+// clang-format off
+const RISCVIntrinsic intrinsic_defs[] = {
+    // VSADD, VSADDU - Saturating add
+    {"vsadd", Int(8), "saturating_add", {Int(8), Int(8)}},
+    {"vsaddu", UInt(8), "saturating_add", {UInt(8), UInt(8)}},
+
+    // VSSUB, VSSUBU - Saturating subtract
+    {"vssub", Int(8), "saturating_sub", {Int(8), Int(8)}},
+    {"vssubu", UInt(8), "saturating_sub", {UInt(8), UInt(8)}},
+
+    // VAADD, VAADDU - Averaging add
+    {"vaadd", Int(8), "rounding_halving_add", {Int(8), Int(8)}, RISCVIntrinsic::RoundNearestUp},
+    {"vaaddu", UInt(8), "rounding_halving_add", {UInt(8), UInt(8)}, RISCVIntrinsic::RoundNearestUp},
+
+    // VSMUL - Fractional multiply with rounding and saturation
+    {"vsmul", Int(8), "rounding_mul_shift_right", {Int(8), Int(8)}, RISCVIntrinsic::RoundNearestUp},
+
+    // VSSRA, VSSRL - Scaling shift right
+    {"vssra", Int(8), "rounding_shift_right", {Int(8), Int(8)}, RISCVIntrinsic::RoundNearestUp},
+    {"vssrl", UInt(8), "rounding_shift_right", {UInt(8), UInt(8)}, RISCVIntrinsic::RoundNearestUp},
+
+    // VWADD, VWADDU - Widening add
+    {"vwadd", Int(16), "widening_add", {Int(8), Int(8)}, RISCVIntrinsic::MangleAllArgs},
+    {"vwaddu", UInt(16), "widening_add", {UInt(8), UInt(8)}, RISCVIntrinsic::MangleAllArgs},
+
+    // VWSUB, VWSUBU - Widening subtract
+    {"vwsub", Int(16), "widening_sub", {Int(8), Int(8)}, RISCVIntrinsic::MangleAllArgs},
+    {"vwsubu", Int(16), "widening_sub", {UInt(8), UInt(8)}, RISCVIntrinsic::MangleAllArgs},
+
+    // VWMUL, VWMULU, VWMULSU - Widening multiply
+    {"vwmul", Int(16), "widening_mul", {Int(8), Int(8)}, RISCVIntrinsic::MangleAllArgs},
+    {"vwmulu", UInt(16), "widening_mul", {UInt(8), UInt(8)}, RISCVIntrinsic::MangleAllArgs},
+    {"vwmulsu", Int(16), "widening_mul", {Int(8), UInt(8)}, RISCVIntrinsic::MangleAllArgs},
+
+    // VWMACC, VWMACCU, VWMACCSU - Widening multiply-add
+    {"vwmacc", Int(16), "widening_mul_add", {Int(16), Int(8), Int(8)}},
+    {"vwmaccu", UInt(16), "widening_mul_add", {UInt(16), UInt(8), UInt(8)}},
+    {"vwmaccsu", Int(16), "widening_mul_add", {Int(16), Int(8), UInt(8)}},
+
+    // VNCLIP, VNCLIPU - Saturating narrowing shift right
+    {"vnclip", Int(8), "saturating_shift_right_narrow", {Int(16), UInt(8)}, RISCVIntrinsic::MangleAllArgs | RISCVIntrinsic::RoundNearestUp},
+    {"vnclipu", UInt(8), "saturating_shift_right_narrow", {UInt(16), UInt(8)}, RISCVIntrinsic::MangleAllArgs | RISCVIntrinsic::RoundNearestUp},
+};
+// clang-format on
+
+llvm::Type *CodeGen_RISCV::scalable_type_of(const Type &t) const {
+    // LLVM's scalable RVV types are multiples of 64 bits.
+    const int min_lanes = t.lanes() * 64 / vlen();
+    internal_assert(min_lanes > 0) << t << "\n";
+    return ScalableVectorType::get(llvm_type_of(t.element_of()), min_lanes);
+}
+
+llvm::Function *CodeGen_RISCV::define_rvv_intrinsic_wrapper(const string &riscv_name, const Type &ret_type,
+                                                            const vector<Type> &arg_types, int flags) {
+    llvm::Type *xlen_t = target.bits == 64 ? i64_t : i32_t;
+
+    // Generate the LLVM mangled name of the intrinsic, and its type.
+    std::stringstream mangled_name_builder;
+    mangled_name_builder << "llvm.riscv." << riscv_name;
+    auto mangle = [&](const Type &t) {
+        mangled_name_builder << ".nxv" << t.lanes() * 64 / vlen() << "i" << t.bits();
+    };
+    mangle(ret_type);
+    vector<llvm::Type *> inner_arg_types;
+    for (size_t i = 0; i < arg_types.size(); i++) {
+        if (i > 0 || (flags & RISCVIntrinsic::MangleAllArgs)) {
+            mangle(arg_types[i]);
+        }
+        inner_arg_types.push_back(scalable_type_of(arg_types[i]));
+    }
+    mangled_name_builder << ".i" << target.bits;
+    inner_arg_types.push_back(xlen_t);
+    llvm::Type *inner_ret_type = scalable_type_of(ret_type);
+    llvm::Function *inner = get_llvm_intrin(inner_ret_type, mangled_name_builder.str(), inner_arg_types);
+
+    // Make a wrapper that takes and returns fixed width vectors.
+    vector<llvm::Type *> wrapper_arg_types;
+    for (const Type &t : arg_types) {
+        wrapper_arg_types.push_back(llvm_type_of(t));
+    }
+    llvm::FunctionType *wrapper_ty =
+        llvm::FunctionType::get(llvm_type_of(ret_type), wrapper_arg_types, false);
+    llvm::Function *wrapper =
+        llvm::Function::Create(wrapper_ty, llvm::GlobalValue::InternalLinkage,
+                               riscv_name + unique_name("_wrapper"), module.get());
+    llvm::BasicBlock *block =
+        llvm::BasicBlock::Create(module->getContext(), "entry", wrapper);
+    IRBuilderBase::InsertPoint here = builder->saveIP();
+    builder->SetInsertPoint(block);
+
+    if (flags & RISCVIntrinsic::RoundNearestUp) {
+        // vxrm isn't preserved across calls, and LLVM doesn't track
+        // it, so set it before each use. This is the only rounding mode
+        // we use, so it doesn't matter if these get reordered.
+        llvm::FunctionType *asm_ty = llvm::FunctionType::get(void_t, false);
+        llvm::InlineAsm *set_vxrm = llvm::InlineAsm::get(asm_ty, "csrwi vxrm, 0", "", true);
+        builder->CreateCall(set_vxrm);
+    }
+
+    vector<Value *> args;
+    for (size_t i = 0; i < arg_types.size(); i++) {
+        llvm::Function *insert = llvm::Intrinsic::getDeclaration(
+            module.get(), llvm::Intrinsic::experimental_vector_insert,
+            {inner_arg_types[i], wrapper_arg_types[i]});
+        args.push_back(builder->CreateCall(insert, {UndefValue::get(inner_arg_types[i]),
+                                                    wrapper->getArg(i),
+                                                    ConstantInt::get(i64_t, 0)}));
+    }
+    // The vector length is the number of lanes we're using.
+    args.push_back(ConstantInt::get(xlen_t, ret_type.lanes()));
+    Value *ret = builder->CreateCall(inner, args);
+    llvm::Function *extract = llvm::Intrinsic::getDeclaration(
+        module.get(), llvm::Intrinsic::experimental_vector_extract,
+        {wrapper_ty->getReturnType(), inner_ret_type});
+    ret = builder->CreateCall(extract, {ret, ConstantInt::get(i64_t, 0)});
+    builder->CreateRet(ret);
+
+    // Always inline these wrappers.
+    wrapper->addFnAttr(llvm::Attribute::AlwaysInline);
+    wrapper->addFnAttr(llvm::Attribute::NoUnwind);
+    if (!(flags & RISCVIntrinsic::RoundNearestUp)) {
+        wrapper->addFnAttr(llvm::Attribute::ReadNone);
+    }
+
+    builder->restoreIP(here);
+
+    llvm::verifyFunction(*wrapper);
+    return wrapper;
+}
+
+void CodeGen_RISCV::init_module() {
+    CodeGen_Posix::init_module();
+
+    if (!rvv_intrinsics_enabled()) {
+        return;
+    }
+
+#if LLVM_VERSION < 150
+    // These LLVMs ignore the vscale_range attribute on RISC-V, and only
+    // use RVV for fixed width vectors if told the minimum width of the
+    // vector registers, which they read from a global option. The
+    // option may only occur once, so reset it before each module.
+    auto &llvm_options = cl::getRegisteredOptions();
+    auto vector_bits_min = llvm_options.find("riscv-v-vector-bits-min");
+    if (vector_bits_min != llvm_options.end()) {
+        vector_bits_min->second->reset();
+        vector_bits_min->second->addOccurrence(0, "riscv-v-vector-bits-min", std::to_string(vlen()));
+    }
+#endif
+
+    for (const RISCVIntrinsic &intrin : intrinsic_defs) {
+        // Generate versions of this intrinsic for each element width,
+        // and for each register group size (LMUL) of the widest
+        // operand. call_overloaded_intrin picks the smallest group that
+        // holds the whole vector, or splits vectors too wide for a
+        // group of eight registers.
+        for (int width_factor = 1; width_factor <= 8; width_factor *= 2) {
+            Type ret_type = intrin.ret_type;
+            ret_type = ret_type.with_bits(ret_type.bits() * width_factor);
+            vector<Type> arg_types;
+            int max_bits = ret_type.bits();
+            for (halide_type_t i : intrin.arg_types) {
+                if (i.bits == 0) {
+                    break;
+                }
+                Type arg_type = i;
+                arg_type = arg_type.with_bits(arg_type.bits() * width_factor);
+                arg_types.push_back(arg_type);
+                max_bits = std::max(max_bits, arg_type.bits());
+            }
+            if (max_bits > 64) {
+                break;
+            }
+
+            for (int lmul = 1; lmul <= 8; lmul *= 2) {
+                const int lanes = vlen() * lmul / max_bits;
+                vector<Type> vector_arg_types;
+                for (const Type &t : arg_types) {
+                    vector_arg_types.push_back(t.with_lanes(lanes));
+                }
+                llvm::Function *intrin_impl =
+                    define_rvv_intrinsic_wrapper(intrin.riscv_name, ret_type.with_lanes(lanes),
+                                                 vector_arg_types, intrin.flags);
+                declare_intrin_overload(intrin.name, ret_type.with_lanes(lanes), intrin_impl, vector_arg_types);
+            }
+        }
+    }
+}
+
+void CodeGen_RISCV::visit(const Add *op) {
+    if (rvv_intrinsics_enabled() && op->type.is_vector() &&
+        (op->type.is_int() || op->type.is_uint())) {
+        // Look for an accumulation of a widening multiply.
+        for (int i = 0; i < 2; i++) {
+            const Expr &acc = i == 0 ? op->a : op->b;
+            const Expr &other = i == 0 ? op->b : op->a;
+            if (const Call *mul = Call::as_intrinsic(other, {Call::widening_mul})) {
+                value = call_overloaded_intrin(op->type, "widening_mul_add", {acc, mul->args[0], mul->args[1]});
+                if (value) {
+                    return;
+                }
+            }
+        }
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
+void CodeGen_RISCV::visit(const Cast *op) {
+    if (rvv_intrinsics_enabled() && op->type.is_vector()) {
+        vector<Expr> matches;
+        for (const Pattern &pattern : casts) {
+            if (expr_match(pattern.pattern, op, matches)) {
+                Type shift_type = op->type.with_code(halide_type_uint).element_of();
+                if (pattern.intrin == "saturating_narrow") {
+                    matches.push_back(make_zero(shift_type));
+                } else {
+                    // The shift needs to be constant, and less than the
+                    // width of the wide operand.
+                    const uint64_t *const_b = as_const_uint(matches[1]);
+                    if (!const_b || *const_b >= (uint64_t)op->value.type().bits()) {
+                        continue;
+                    }
+                    matches[1] = make_const(shift_type, *const_b);
+                }
+                value = call_overloaded_intrin(op->type, "saturating_shift_right_narrow", matches);
+                if (value) {
+                    return;
+                }
+            }
+        }
+    }
+
+    CodeGen_Posix::visit(op);
+}
+
+void CodeGen_RISCV::visit(const Call *op) {
+    if (rvv_intrinsics_enabled() && op->type.is_vector() &&
+        (op->type.is_int() || op->type.is_uint())) {
+        if (op->is_intrinsic(Call::rounding_shift_right)) {
+            // The scaling shifts only shift right, by the low bits of
+            // the shift.
+            int64_t b = -1;
+            if (const uint64_t *const_b = as_const_uint(op->args[1])) {
+                b = (int64_t)std::min(*const_b, (uint64_t)op->type.bits());
+            } else if (const int64_t *const_b = as_const_int(op->args[1])) {
+                b = *const_b;
+            }
+            if (b >= 0 && b < op->type.bits()) {
+                value = call_overloaded_intrin(op->type, op->name, {op->args[0], make_const(op->type.element_of(), b)});
+                if (value) {
+                    return;
+                }
+            }
+        } else if (op->is_intrinsic(Call::rounding_mul_shift_right)) {
+            // VSMUL is a signed fixed-point multiply.
+            const uint64_t *const_q = as_const_uint(op->args[2]);
+            if (op->type.is_int() && const_q && (int)*const_q == op->type.bits() - 1 &&
+                op->args[0].type() == op->type && op->args[1].type() == op->type) {
+                value = call_overloaded_intrin(op->type, op->name, {op->args[0], op->args[1]});
+                if (value) {
+                    return;
+                }
+            }
+        } else if (op->is_intrinsic({Call::saturating_add, Call::saturating_sub,
+                                     Call::rounding_halving_add, Call::widening_add,
+                                     Call::widening_sub, Call::widening_mul})) {
+            value = call_overloaded_intrin(op->type, op->name, op->args);
+            if (value) {
+                return;
+            }
+        }
+    }
+
+    CodeGen_Posix::visit(op);
 }
 
 string CodeGen_RISCV::mcpu() const {
@@ -45,7 +403,11 @@ string CodeGen_RISCV::mattrs() const {
     string arch_flags = "+m,+a,+f,+d,+c";
 
     if (target.has_feature(Target::RVV)) {
+#if LLVM_VERSION >= 140
+        arch_flags += ",+v";
+#else
         arch_flags += ",+experimental-v";
+#endif
     }
     return arch_flags;
 }
@@ -68,7 +430,7 @@ bool CodeGen_RISCV::use_soft_float_abi() const {
 }
 
 int CodeGen_RISCV::native_vector_bits() const {
-    return 128;
+    return vlen();
 }
 
 }  // namespace
@@ -281,7 +281,7 @@ string CodeGen_WebAssembly::mattrs() const {
     if (target.has_feature(Target::WasmThreads)) {
         // "WasmThreads" doesn't directly affect LLVM codegen,
         // but it does end up requiring atomics, so be sure to enable them.
-        s << sep << ",+atomics";
+        s << sep << "+atomics";
         sep = ",";
     }
 
@@ -1,3 +1,4 @@
+#include "CodeGen_Internal.h"
 #include "CodeGen_Posix.h"
 #include "ConciseCasts.h"
 #include "Debug.h"
@@ -25,6 +26,12 @@ namespace {
 // existing flags, so that instruction patterns can just check for the
 // oldest feature flag that supports an instruction.
 Target complete_x86_target(Target t) {
+    if (t.has_feature(Target::AVX512_SapphireRapids)) {
+        t.set_feature(Target::F16C);
+    }
+    if (t.has_feature(Target::AVXVNNI)) {
+        t.set_feature(Target::AVX2);
+    }
     if (t.has_feature(Target::AVX512_SapphireRapids)) {
         t.set_feature(Target::AVX512_Cannonlake);
     }
@@ -62,9 +69,31 @@ protected:
 
     llvm::Type *llvm_type_of(const Type &t) const override;
 
+    /** Sapphire Rapids has AVX512-FP16, so we can do float16 math
+     * without widening it to float32. LLVM only knows it from LLVM 14. */
+    bool has_native_float16(const Type &t) const {
+#if LLVM_VERSION >= 140
+        return t.code() == Type::Float && t.bits() == 16 &&
+               target.has_feature(Target::AVX512_SapphireRapids);
+#else
+        return false;
+#endif
+    }
+    Type upgrade_type_for_arithmetic(const Type &t) const override;
+
+    Value *deinterleave_vector(Value *vec, int offset, int stride, int lanes) override;
+
+    /** With AVX-512, make masks in a general-purpose register and move
+     * them to a mask register. */
+    Value *active_lane_mask(Value *active_lanes, int lanes) override;
+
     using CodeGen_Posix::visit;
 
     void init_module() override;
+    void set_target(const Target &t) override;
+
+    /** Declare the intrinsics in intrinsic_defs that the target has. */
+    void declare_intrinsics();
 
     /** Nodes for which we want to emit specific sse/avx intrinsics */
     // @{
@@ -198,22 +227,32 @@ const x86Intrinsic intrinsic_defs[] = {
     {"dpbusdx16", Int(32, 16), "dot_product", {Int(32, 16), UInt(8, 64), Int(8, 64)}, Target::AVX512_SapphireRapids},
     {"dpbusdx8", Int(32, 8), "dot_product", {Int(32, 8), UInt(8, 32), Int(8, 32)}, Target::AVX512_SapphireRapids},
     {"dpbusdx4", Int(32, 4), "dot_product", {Int(32, 4), UInt(8, 16), Int(8, 16)}, Target::AVX512_SapphireRapids},
+    {"dpbusdx8", Int(32, 8), "dot_product", {Int(32, 8), UInt(8, 32), Int(8, 32)}, Target::AVXVNNI},
+    {"dpbusdx4", Int(32, 4), "dot_product", {Int(32, 4), UInt(8, 16), Int(8, 16)}, Target::AVXVNNI},
 
     {"dpwssdx16", Int(32, 16), "dot_product", {Int(32, 16), Int(16, 32), Int(16, 32)}, Target::AVX512_SapphireRapids},
     {"dpwssdx8", Int(32, 8), "dot_product", {Int(32, 8), Int(16, 16), Int(16, 16)}, Target::AVX512_SapphireRapids},
     {"dpwssdx4", Int(32, 4), "dot_product", {Int(32, 4), Int(16, 8), Int(16, 8)}, Target::AVX512_SapphireRapids},
+    {"dpwssdx8", Int(32, 8), "dot_product", {Int(32, 8), Int(16, 16), Int(16, 16)}, Target::AVXVNNI},
+    {"dpwssdx4", Int(32, 4), "dot_product", {Int(32, 4), Int(16, 8), Int(16, 8)}, Target::AVXVNNI},
 
     {"dpbusdsx16", Int(32, 16), "saturating_dot_product", {Int(32, 16), UInt(8, 64), Int(8, 64)}, Target::AVX512_SapphireRapids},
     {"dpbusdsx8", Int(32, 8), "saturating_dot_product", {Int(32, 8), UInt(8, 32), Int(8, 32)}, Target::AVX512_SapphireRapids},
     {"dpbusdsx4", Int(32, 4), "saturating_dot_product", {Int(32, 4), UInt(8, 16), Int(8, 16)}, Target::AVX512_SapphireRapids},
+    {"dpbusdsx8", Int(32, 8), "saturating_dot_product", {Int(32, 8), UInt(8, 32), Int(8, 32)}, Target::AVXVNNI},
+    {"dpbusdsx4", Int(32, 4), "saturating_dot_product", {Int(32, 4), UInt(8, 16), Int(8, 16)}, Target::AVXVNNI},
 
     {"dpwssdsx16", Int(32, 16), "saturating_dot_product", {Int(32, 16), Int(16, 32), Int(16, 32)}, Target::AVX512_SapphireRapids},
     {"dpwssdsx8", Int(32, 8), "saturating_dot_product", {Int(32, 8), Int(16, 16), Int(16, 16)}, Target::AVX512_SapphireRapids},
     {"dpwssdsx4", Int(32, 4), "saturating_dot_product", {Int(32, 4), Int(16, 8), Int(16, 8)}, Target::AVX512_SapphireRapids},
+    {"dpwssdsx8", Int(32, 8), "saturating_dot_product", {Int(32, 8), Int(16, 16), Int(16, 16)}, Target::AVXVNNI},
+    {"dpwssdsx4", Int(32, 4), "saturating_dot_product", {Int(32, 4), Int(16, 8), Int(16, 8)}, Target::AVXVNNI},
 
     {"tileloadd64_i8", Int(8, 1024), "tile_load", {Int(16), Int(16), Handle(), Int(64), Int(64)}, Target::AVX512_SapphireRapids, x86Intrinsic::AccessesMemory},
     {"tileloadd64_i8", UInt(8, 1024), "tile_load", {Int(16), Int(16), Handle(), Int(64), Int(64)}, Target::AVX512_SapphireRapids, x86Intrinsic::AccessesMemory},
     {"tileloadd64_bf16", BFloat(16, 512), "tile_load", {Int(16), Int(16), Handle(), Int(64), Int(64)}, Target::AVX512_SapphireRapids, x86Intrinsic::AccessesMemory},
+    {"tileloadd64_i32", Int(32, 256), "tile_load", {Int(16), Int(16), Handle(), Int(64), Int(64)}, Target::AVX512_SapphireRapids, x86Intrinsic::AccessesMemory},
+    {"tileloadd64_f32", Float(32, 256), "tile_load", {Int(16), Int(16), Handle(), Int(64), Int(64)}, Target::AVX512_SapphireRapids, x86Intrinsic::AccessesMemory},
     {"tdpbssd", Int(32, 256), "tile_matmul", {Int(16), Int(16), Int(16), Int(32, 256), Int(8, 1024), Int(8, 1024)},  Target::AVX512_SapphireRapids},
     {"tdpbsud", Int(32, 256), "tile_matmul", {Int(16), Int(16), Int(16), Int(32, 256), Int(8, 1024), UInt(8, 1024)}, Target::AVX512_SapphireRapids},
     {"tdpbusd", Int(32, 256), "tile_matmul", {Int(16), Int(16), Int(16), Int(32, 256), UInt(8, 1024), Int(8, 1024)}, Target::AVX512_SapphireRapids},
@@ -228,7 +267,17 @@ const x86Intrinsic intrinsic_defs[] = {
 
 void CodeGen_X86::init_module() {
     CodeGen_Posix::init_module();
+    declare_intrinsics();
+}
+
+void CodeGen_X86::set_target(const Target &t) {
+    CodeGen_Posix::set_target(complete_x86_target(t));
+    // Only offer the intrinsics the new target has.
+    intrinsics.clear();
+    declare_intrinsics();
+}
 
+void CodeGen_X86::declare_intrinsics() {
     for (const x86Intrinsic &i : intrinsic_defs) {
         if (i.feature != Target::FeatureEnd && !target.has_feature(i.feature)) {
             continue;
@@ -437,6 +486,22 @@ void CodeGen_X86::visit(const Select *op) {
 }
 
 void CodeGen_X86::visit(const Cast *op) {
+    const Type &src = op->value.type();
+    if (target.has_feature(Target::F16C) && !has_native_float16(Float(16)) &&
+        ((src == Float(16, src.lanes()) && op->type == Float(32, src.lanes())) ||
+         (src == Float(32, src.lanes()) && op->type == Float(16, src.lanes())))) {
+        // F16C converts between float16 and float32 in one
+        // instruction. Our float16 values are otherwise int16 vectors
+        // (see llvm_type_of below).
+        llvm::Type *half_t = CodeGen_Posix::llvm_type_of(Float(16, src.lanes()));
+        Value *v = codegen(op->value);
+        if (op->type.bits() == 32) {
+            value = builder->CreateFPExt(builder->CreateBitCast(v, half_t), llvm_type_of(op->type));
+        } else {
+            value = builder->CreateBitCast(builder->CreateFPTrunc(v, half_t), llvm_type_of(op->type));
+        }
+        return;
+    }
 
     if (!op->type.is_vector()) {
         // We only have peephole optimizations for vectors in here.
@@ -627,6 +692,35 @@ void CodeGen_X86::visit(const Load *op) {
     CodeGen_Posix::visit(op);
 }
 
+Value *CodeGen_X86::active_lane_mask(Value *active_lanes, int lanes) {
+    // A mask register holds one bit per lane, so the mask for the first
+    // n lanes is just (1 << n) - 1, computed with scalar instructions
+    // and moved over with a kmov, instead of comparing a vector of lane
+    // indices. Moving 32 or 64 bits at a time needs AVX512BW.
+    const bool has_avx512 = target.features_any_of({Target::AVX512, Target::AVX512_KNL, Target::AVX512_Skylake});
+    const bool has_avx512bw = target.has_feature(Target::AVX512_Skylake);
+    if (!((has_avx512 && (lanes == 8 || lanes == 16)) ||
+          (has_avx512bw && (lanes == 32 || lanes == 64)))) {
+        return CodeGen_Posix::active_lane_mask(active_lanes, lanes);
+    }
+
+    llvm::Type *wide_t = lanes <= 16 ? i32_t : i64_t;
+    Value *zero = ConstantInt::get(i32_t, 0);
+    Value *max_lanes = ConstantInt::get(i32_t, lanes);
+    Value *n = builder->CreateSelect(builder->CreateICmpSLT(active_lanes, zero), zero, active_lanes);
+    n = builder->CreateSelect(builder->CreateICmpSGT(n, max_lanes), max_lanes, n);
+    n = builder->CreateZExt(n, wide_t);
+    Value *mask = builder->CreateSub(builder->CreateShl(ConstantInt::get(wide_t, 1), n),
+                                     ConstantInt::get(wide_t, 1));
+    if (lanes == 64) {
+        // Shifting by the full width is poison.
+        mask = builder->CreateSelect(builder->CreateICmpEQ(n, ConstantInt::get(wide_t, 64)),
+                                     ConstantInt::getAllOnesValue(wide_t), mask);
+    }
+    mask = builder->CreateTrunc(mask, llvm::Type::getIntNTy(*context, lanes));
+    return builder->CreateBitCast(mask, get_vector_type(i1_t, lanes));
+}
+
 void CodeGen_X86::visit(const Store *op) {
     if (mem_type.contains(op->name) && mem_type.get(op->name) == MemoryType::AMXTile) {
         Value *val = codegen(op->value);
@@ -678,6 +772,10 @@ string CodeGen_X86::mattrs() const {
         features += separator + "+f16c";
         separator = ",";
     }
+    if (target.has_feature(Target::AVXVNNI)) {
+        features += separator + "+avxvnni";
+        separator = ",";
+    }
     if (target.has_feature(Target::AVX512) ||
         target.has_feature(Target::AVX512_KNL) ||
         target.has_feature(Target::AVX512_Skylake) ||
@@ -696,6 +794,9 @@ string CodeGen_X86::mattrs() const {
         }
         if (target.has_feature(Target::AVX512_SapphireRapids)) {
             features += ",+avx512bf16,+avx512vnni,+amx-int8,+amx-bf16";
+#if LLVM_VERSION >= 140
+            features += ",+avx512fp16";
+#endif
         }
     }
     return features;
@@ -733,8 +834,58 @@ int CodeGen_X86::vector_lanes_for_slice(const Type &t) const {
     return slice_bits / t.bits();
 }
 
+Value *CodeGen_X86::deinterleave_vector(Value *vec, int offset, int stride, int lanes) {
+    // LLVM compiles a single shuffle that takes every second or fourth
+    // lane of several native vectors into a long sequence of inserts
+    // and blends. Instead, group the lanes of each native vector by
+    // their index mod the stride, and then gather the blocks we want,
+    // which is just unpacks and permutes. The grouping step is the
+    // same for all the strided loads sharing this dense load, so LLVM
+    // only does it once.
+    const int bits = vec->getType()->getScalarSizeInBits();
+    const bool profitable = target.has_feature(Target::AVX2) ||
+                            (native_vector_bits() == 128 && bits < 32);
+    if ((stride != 2 && stride != 4) ||
+        lanes * bits != native_vector_bits() ||
+        get_vector_num_elements(vec->getType()) > lanes * stride ||
+        !profitable) {
+        return CodeGen_Posix::deinterleave_vector(vec, offset, stride, lanes);
+    }
+    // Loads from external buffers may stop short of the last few
+    // lanes, which we don't need.
+    vec = slice_vector(vec, 0, lanes * stride);
+
+    const int block = lanes / stride;
+    vector<int> indices(lanes);
+    for (int i = 0; i < lanes; i++) {
+        indices[i] = (i % block) * stride + i / block;
+    }
+    vector<Value *> grouped(stride);
+    for (int i = 0; i < stride; i++) {
+        grouped[i] = shuffle_vectors(slice_vector(vec, i * lanes, lanes), indices);
+    }
+
+    indices.resize(block * 2);
+    for (int i = 0; i < block; i++) {
+        indices[i] = offset * block + i;
+        indices[i + block] = lanes + offset * block + i;
+    }
+    vector<Value *> pairs;
+    for (int i = 0; i < stride; i += 2) {
+        pairs.push_back(shuffle_vectors(grouped[i], grouped[i + 1], indices));
+    }
+    return concat_vectors(pairs);
+}
+
+Type CodeGen_X86::upgrade_type_for_arithmetic(const Type &t) const {
+    if (has_native_float16(t)) {
+        return t;
+    }
+    return CodeGen_Posix::upgrade_type_for_arithmetic(t);
+}
+
 llvm::Type *CodeGen_X86::llvm_type_of(const Type &t) const {
-    if (t.is_float() && t.bits() < 32) {
+    if (t.is_float() && t.bits() < 32 && !has_native_float16(t)) {
         // LLVM as of August 2019 has all sorts of issues in the x86
         // backend for half types. It injects expensive calls to
         // convert between float and half for seemingly no reason
@@ -111,8 +111,84 @@ Expr float32_to_float16(Expr value) {
     return common_subexpression_elimination(reinterpret(f16_t, bits));
 }
 
+Expr float32_round_to_bfloat16(Expr e) {
+    internal_assert(e.type().bits() == 32);
+    e = strict_float(e);
+    Type u32_t = UInt(32, e.type().lanes());
+    e = reinterpret(u32_t, e);
+    // Round the same way as float32_to_bfloat16, but clear the low
+    // bits instead of shifting them out.
+    e += 0x7fff + ((e >> 16) & 1);
+    e = e & make_const(u32_t, 0xffff0000);
+    return strict_float(reinterpret(Float(32, e.type().lanes()), e));
+}
+
+Expr float32_round_to_float16(Expr value) {
+    value = strict_float(value);
+
+    Type f32_t = Float(32, value.type().lanes());
+    Type u32_t = UInt(32, value.type().lanes());
+
+    Expr bits = reinterpret(u32_t, value);
+    Expr sign = bits & make_const(u32_t, 0x80000000);
+    bits = bits ^ sign;
+
+    // Denorms are multiples of 2^-24, so scale them up by 2^24, round
+    // to an integer, and scale back down.
+    Expr denorm_bits = reinterpret(u32_t, strict_float(round(strict_float(reinterpret(f32_t, bits + 0x0c000000)))));
+    denorm_bits = select(denorm_bits == 0, make_zero(u32_t), denorm_bits - 0x0c000000);
+
+    // Otherwise round the mantissa to 10 bits, to nearest even.
+    Expr rounded = (bits + ((bits >> 13) & 1) + 0xfff) & make_const(u32_t, 0xffffe000);
+
+    bits = select(bits < make_const(u32_t, 0x38800000), denorm_bits,
+                  bits > make_const(u32_t, 0x7f800000), make_const(u32_t, 0x7fffe000),  // The NaN float32_to_float16 makes
+                  rounded >= make_const(u32_t, 0x47800000), make_const(u32_t, 0x7f800000),
+                  rounded);
+    Expr f32 = strict_float(reinterpret(f32_t, bits | sign));
+    return common_subexpression_elimination(f32);
+}
+
 namespace {
 
+// Compute a float16 or bfloat16 expression in float32. Each operation
+// is still rounded to the narrow type, but the results stay in float32
+// registers, rather than being packed into 16 bits and unpacked again
+// by the next operation.
+Expr widen_float16_math(const Expr &e) {
+    Type t = e.type();
+    Type f32_t = Float(32, t.lanes());
+    auto round_to_narrow = [&](const Expr &x) {
+        return t.is_bfloat() ? float32_round_to_bfloat16(x) : float32_round_to_float16(x);
+    };
+
+    if (const Cast *op = e.as<Cast>()) {
+        if (op->value.type() == f32_t) {
+            return round_to_narrow(op->value);
+        }
+    } else if (const Add *op = e.as<Add>()) {
+        return round_to_narrow(widen_float16_math(op->a) + widen_float16_math(op->b));
+    } else if (const Sub *op = e.as<Sub>()) {
+        return round_to_narrow(widen_float16_math(op->a) - widen_float16_math(op->b));
+    } else if (const Mul *op = e.as<Mul>()) {
+        return round_to_narrow(widen_float16_math(op->a) * widen_float16_math(op->b));
+    } else if (const Div *op = e.as<Div>()) {
+        return round_to_narrow(widen_float16_math(op->a) / widen_float16_math(op->b));
+    } else if (const Min *op = e.as<Min>()) {
+        return min(widen_float16_math(op->a), widen_float16_math(op->b));
+    } else if (const Max *op = e.as<Max>()) {
+        return max(widen_float16_math(op->a), widen_float16_math(op->b));
+    } else if (const Select *op = e.as<Select>()) {
+        return select(op->condition, widen_float16_math(op->true_value), widen_float16_math(op->false_value));
+    } else if (const Broadcast *op = e.as<Broadcast>()) {
+        return Broadcast::make(widen_float16_math(op->value), op->lanes);
+    } else if (const FloatImm *op = e.as<FloatImm>()) {
+        return make_const(f32_t, op->value);
+    }
+
+    return t.is_bfloat() ? bfloat16_to_float32(e) : float16_to_float32(e);
+}
+
 const std::map<std::string, std::string> transcendental_remapping =
     {{"sin_f16", "sin_f32"},
      {"asin_f16", "asin_f32"},
@@ -149,7 +225,7 @@ Expr lower_float16_transcendental_to_float32_equivalent(const Call *op) {
     if (it != transcendental_remapping.end()) {
         std::vector<Expr> new_args(op->args.size());
         for (size_t i = 0; i < op->args.size(); i++) {
-            new_args[i] = float16_to_float32(op->args[i]);
+            new_args[i] = widen_float16_math(op->args[i]);
         }
         Expr e = Call::make(Float(32, op->type.lanes()), it->second, new_args, op->call_type,
                             op->func, op->value_index, op->image, op->param);
@@ -166,12 +242,9 @@ Expr lower_float16_cast(const Cast *op) {
     Type f32 = Float(32, dst.lanes());
     Expr val = op->value;
 
-    if (src.is_bfloat()) {
-        internal_assert(src.bits() == 16);
-        val = bfloat16_to_float32(val);
-    } else if (src.is_float() && src.bits() < 32) {
+    if (src.is_float() && src.bits() < 32) {
         internal_assert(src.bits() == 16);
-        val = float16_to_float32(val);
+        val = widen_float16_math(val);
     }
 
     if (dst.is_bfloat()) {
@@ -26,6 +26,14 @@ Expr bfloat16_to_float32(Expr e);
 Expr lower_float16_cast(const Cast *op);
 //@}
 
+/** Round a float32 to the nearest value representable as a bfloat16 or
+ * float16, without changing its type. Equivalent to, but cheaper than,
+ * casting to the narrow type and back. */
+//@{
+Expr float32_round_to_bfloat16(Expr e);
+Expr float32_round_to_float16(Expr e);
+//@}
+
 }  // namespace Internal
 }  // namespace Halide
 
@@ -3,6 +3,8 @@
 #include "IRMatch.h"
 #include "IRMutator.h"
 #include "IROperator.h"
+#include "IRVisitor.h"
+#include "Target.h"
 #include "Util.h"
 
 namespace Halide {
@@ -64,6 +66,23 @@ Tile<2> get_2d_tile_index(const Expr &e) {
     return {};
 }
 
+// Get the index of a tile_x by tile_y tile with dense rows, which may have
+// been simplified to a 1d ramp if the rows are also contiguous.
+Tile<2> get_dense_2d_tile_index(const Expr &e, int tile_x, int tile_y) {
+    auto tile = get_2d_tile_index(e);
+    if (tile.result) {
+        if (tile.extent[0] == tile_x && tile.extent[1] == tile_y && is_const_one(tile.stride[1])) {
+            return tile;
+        }
+        return {};
+    }
+    auto row = get_1d_tile_index(e);
+    if (row.result && row.extent[0] == tile_x * tile_y && is_const_one(row.stride[0])) {
+        return {true, row.base, {Expr(tile_y), Expr(1)}, {tile_x, tile_y}};
+    }
+    return {};
+}
+
 Tile<3> get_3d_tile_index(const Expr &e) {
     vector<Expr> matches;
 
@@ -143,14 +162,27 @@ Tile<3> get_3d_tile_index(const Expr &e) {
     return {true, base, {x_stride, 0, r_stride}, {x_tile, y_tile, r_tile}};
 }
 
+// An AMX tile has at most 16 rows of at most 64 bytes.
+constexpr int max_tile_rows = 16;
+constexpr int max_tile_colbytes = 64;
+
 struct Matmul {
     bool result = false;
     Stmt stmt;
     int tile_x;
     int tile_y;
     int tile_r;
+    // If the store is a matrix multiply that can't be done with AMX
+    // instructions, the reason why.
+    string failure;
 };
 
+Matmul matmul_failure(const string &failure) {
+    Matmul m;
+    m.failure = failure;
+    return m;
+}
+
 Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_type) {
     // m[ramp(0, 1, S)] = VectorAdd(lhs[{XYR tile}] * xX(rhs[{YR tile}])) + m[ramp(0, 1, S)]
     const auto wild_i8x = Variable::make(Int(8, 0), "*");
@@ -180,19 +212,30 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
         return {};
     }
 
-    if (op_type == AMXOpType::Int8) {
-        auto pattern2 = cast(Int(32, 0), cast(Int(32, 0), wild_i8x) * wild_i32x);
-        auto pattern2_unsigned = cast(Int(32, 0), cast(Int(32, 0), wild_u8x) * wild_i32x);
+    // The operands of the multiply may be in either order.
+    vector<Expr> products = {reduce->value};
+    if (const auto *mul = reduce->value.as<Mul>()) {
+        products.push_back(Mul::make(mul->b, mul->a));
+    }
 
-        if (!(expr_match(pattern2, reduce->value, matches) || expr_match(pattern2_unsigned, reduce->value, matches))) {
-            return {};
-        }
-    } else {
-        auto pattern2 = cast(Float(32, 0), cast(Float(32, 0), wild_bf16x) * wild_f32x);
+    bool is_product = false;
+    for (const Expr &product : products) {
+        if (op_type == AMXOpType::Int8) {
+            auto pattern2 = cast(Int(32, 0), cast(Int(32, 0), wild_i8x) * wild_i32x);
+            auto pattern2_unsigned = cast(Int(32, 0), cast(Int(32, 0), wild_u8x) * wild_i32x);
 
-        if (!expr_match(pattern2, reduce->value, matches)) {
-            return {};
+            is_product = expr_match(pattern2, product, matches) || expr_match(pattern2_unsigned, product, matches);
+        } else {
+            auto pattern2 = cast(Float(32, 0), cast(Float(32, 0), wild_bf16x) * wild_f32x);
+
+            is_product = expr_match(pattern2, product, matches);
         }
+        if (is_product && matches[0].as<Load>() && matches[1].as<Broadcast>()) {
+            break;
+        }
+    }
+    if (!is_product) {
+        return {};
     }
 
     const auto *lhs_load = matches[0].as<Load>();
@@ -228,6 +271,13 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
     const int tile_y = lhs_tile.extent[1];
     const int tile_r = lhs_tile.extent[2];
     const int factor = reduce->value.type().lanes() / reduce->type.lanes();
+    const int element_width = lhs_load->type.bytes();
+
+    // The tile loads read rows of contiguous bytes, so a transposed
+    // operand would have to be packed into another buffer first.
+    if (!is_const_one(lhs_tile.stride[2])) {
+        return matmul_failure("the lhs " + lhs_load->name + " is not dense along the reduction, so it would have to be transposed");
+    }
 
     Expr rhs_base;
     Expr rhs_stride;
@@ -243,6 +293,9 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
         if (rhs_tile1.extent[0] != tile_y * tile_r) {
             return {};
         }
+        if (!is_const_one(rhs_tile1.stride[0])) {
+            return matmul_failure("the rhs " + rhs_load->name + " is not dense, so it would have to be packed");
+        }
 
         rhs_base = rhs_tile1.base;
         rhs_stride = rhs_tile1.stride[0];
@@ -250,6 +303,9 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
         if (tile_y != rhs_tile2.extent[0] || tile_r != rhs_tile2.extent[1]) {
             return {};
         }
+        if (!is_const_one(rhs_tile2.stride[1]) || !is_const(rhs_tile2.stride[0], tile_r)) {
+            return matmul_failure("the rhs " + rhs_load->name + " is not packed with the reduction innermost, so it would have to be transposed");
+        }
 
         rhs_base = rhs_tile2.base;
         rhs_stride = rhs_tile2.stride[0];
@@ -260,6 +316,18 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
         return {};
     }
 
+    // Each tile_matmul multiplies by a single row of the rhs, which
+    // holds four bytes of the reduction for each column.
+    if (tile_r * element_width != 4) {
+        return matmul_failure("the reduction is split by " + std::to_string(tile_r) +
+                              " instead of " + std::to_string(4 / element_width));
+    }
+    if (tile_x > max_tile_rows || tile_y * 4 > max_tile_colbytes) {
+        return matmul_failure("its " + std::to_string(tile_x) + "x" + std::to_string(tile_y) +
+                              " tile is larger than the " + std::to_string(max_tile_rows) + "x" +
+                              std::to_string(max_tile_colbytes / 4) + " supported by AMX");
+    }
+
 #if LLVM_VERSION < 130
     user_assert(op_type != AMXOpType::Bfloat16 &&
                 lhs_load->type.is_int() && rhs_cast->value.type().is_int())
@@ -269,7 +337,6 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
     // {rows, colbytes, var, index}
     auto lhs_var = Variable::make(Handle(), lhs_load->name);
     const auto &lhs_load_type = lhs_load->type;
-    int element_width = lhs_load_type.bytes();
     auto lhs_type = lhs_load_type.with_lanes(1024 / element_width);
     auto lhs = Call::make(lhs_type, "tile_load", {tile_x, tile_r * element_width, lhs_var, lhs_tile.base * element_width, lhs_tile.stride[0] * element_width}, Call::Intrinsic);
 
@@ -284,7 +351,7 @@ Matmul convert_to_matmul(const Store *op, const string &new_name, AMXOpType op_t
 
     // 4 bytes for i32, f32
     auto colbytes = tile_y * 4;
-    auto matmul = Call::make(res_type, "tile_matmul", {tile_x, colbytes, tile_r, out, lhs, rhs}, Call::Intrinsic);
+    auto matmul = Call::make(res_type, "tile_matmul", {tile_x, colbytes, tile_r * element_width, out, lhs, rhs}, Call::Intrinsic);
     auto store = Store::make(new_name, matmul, Ramp::make(0, 1, 256), Parameter(), const_true(256), ModulusRemainder());
     return {true, std::move(store), tile_x, tile_y, tile_r};
 }
@@ -310,14 +377,51 @@ Stmt convert_to_zero(const Store *op, int tile_x, int tile_y, const string &new_
     return {};
 }
 
-Stmt convert_to_tile_store(const Store *op, const string &amx_name, int tile_x, int tile_y) {
-    auto tile = get_2d_tile_index(op->index);
-    if (tile.result && tile.extent[0] == tile_x && tile.extent[1] == tile_y) {
-        auto out = Variable::make(Handle(), op->name);
-        auto tile_type = op->value.type().with_lanes(256);
+Stmt convert_to_tile_load(const Store *op, int tile_x, int tile_y, const string &new_name) {
+    // Initializing the tile with a load instead of zero accumulates the
+    // matmul into the loaded values, such as a partial result or a bias.
+    const auto *ramp = op->index.as<Ramp>();
+    const auto *load = op->value.as<Load>();
+    if (!ramp || !load || !is_const_one(ramp->stride) || ramp->lanes != tile_x * tile_y) {
+        return {};
+    }
+
+    Expr base, stride;
+    const auto tile = get_dense_2d_tile_index(load->index, tile_x, tile_y);
+    if (tile.result) {
+        base = tile.base;
+        stride = tile.stride[0];
+    } else if (const auto *bcast = load->index.as<Broadcast>()) {
+        // The same row for every row of the tile, which is loaded with a
+        // stride of zero.
+        const auto row = get_1d_tile_index(bcast->value);
+        if (!row.result || row.extent[0] != tile_y || bcast->lanes != tile_x || !is_const_one(row.stride[0])) {
+            return {};
+        }
+        base = row.base;
+        stride = 0;
+    } else {
+        return {};
+    }
+
+    auto bytes = op->value.type().bytes();
+    auto var = Variable::make(Handle(), load->name);
+    auto tile_type = op->value.type().with_lanes(256);
+    // {rows, colbytes, var, index, stride}
+    auto val = Call::make(tile_type, "tile_load", {tile_x, tile_y * bytes, std::move(var), base * bytes, stride * bytes}, Call::Intrinsic);
+    return Store::make(new_name, std::move(val), Ramp::make(0, 1, 256), Parameter(), const_true(256), ModulusRemainder());
+}
+
+// Store the tile, whose elements have the given type, to out_name at
+// the given index, in units of the tile's elements.
+Stmt convert_to_tile_store(const Type &element_type, const Expr &index, const string &amx_name, const string &out_name, int tile_x, int tile_y) {
+    auto tile = get_dense_2d_tile_index(index, tile_x, tile_y);
+    if (tile.result) {
+        auto out = Variable::make(Handle(), out_name);
+        auto tile_type = element_type.with_lanes(256);
         auto tile_val = Load::make(tile_type, amx_name, Ramp::make(0, 1, 256), {}, {}, const_true(256), {});
-        auto bytes = op->value.type().bytes();
-        internal_assert(bytes == 4) << "AMX store only supported for int32 and float32 output, not for " << op->value.type() << "\n";
+        auto bytes = element_type.bytes();
+        internal_assert(bytes == 4) << "AMX store only supported for int32 and float32 output, not for " << element_type << "\n";
         // {tile_x, tile_y, var, base, stride}
         auto store = Call::make(Int(32), "tile_store", {tile_x, tile_y * bytes, std::move(out), tile.base * bytes, tile.stride[0] * bytes, std::move(tile_val)}, Call::Intrinsic);
         return Evaluate::make(std::move(store));
@@ -325,9 +429,31 @@ Stmt convert_to_tile_store(const Store *op, const string &amx_name, int tile_x,
     return {};
 }
 
+// Find the indices of the loads from a buffer.
+class FindLoads : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &name;
+
+    void visit(const Load *op) override {
+        if (op->name == name) {
+            indices.push_back(op->index);
+        }
+        IRVisitor::visit(op);
+    }
+
+public:
+    vector<Expr> indices;
+
+    FindLoads(const string &name)
+        : name(name) {
+    }
+};
+
 class ExtractTileOperations : public IRMutator {
     using IRMutator::visit;
 
+    const Target &target;
     string tile_name;
     string amx_name;
     vector<Stmt> pending_stores;
@@ -337,37 +463,75 @@ class ExtractTileOperations : public IRMutator {
     int found_tile_r = -1;
     AMXOpType op_type;
 
+    // Whether a consumer of the tile does more than copy it, so the tile
+    // must be stored to the original allocation first.
+    bool needs_epilogue = false;
+
+    // Whether we're going back over the stores to the tile that were
+    // found before the matmul.
+    bool in_pending = false;
+
+    // Why the current tile allocation can't use AMX instructions, if it
+    // can't.
+    string failure;
+
+    void fail(const string &reason) {
+        if (failure.empty()) {
+            failure = reason;
+        }
+    }
+
     Stmt visit(const Allocate *op) override {
         if (op->memory_type == MemoryType::AMXTile) {
-            user_assert(
-                (op->type.is_int() && op->type.bits() == 32) ||
-                (op->type.is_float() && op->type.bits() == 32))
-                << "scheduled tile operations must yield 32-bit integers or 32-bit floats";
+            user_assert(!in_allocate) << "Already in AMX allocation: " << amx_name;
+            ScopedValue<string> old_amx_name(amx_name, op->name + ".amx");
+            ScopedValue<string> old_tile_name(tile_name, op->name);
+            ScopedValue<bool> old_in_alloc(in_allocate, true);
+            ScopedValue<int> old_tile_x(found_tile_x, -1);
+            ScopedValue<int> old_tile_y(found_tile_y, -1);
+            ScopedValue<int> old_tile_r(found_tile_r, -1);
+            ScopedValue<bool> old_needs_epilogue(needs_epilogue, false);
+            ScopedValue<string> old_failure(failure, "");
 
             if (op->type.is_int() && op->type.bits() == 32) {
                 op_type = AMXOpType::Int8;
-            } else {
+            } else if (op->type.is_float() && op->type.bits() == 32) {
                 op_type = AMXOpType::Bfloat16;
+            } else {
+                fail("scheduled tile operations must yield 32-bit integers or 32-bit floats");
+            }
+            if (!target.has_feature(Target::AVX512_SapphireRapids)) {
+                fail("the target does not have AMX instructions (avx512_sapphirerapids)");
             }
 
-            user_assert(!in_allocate) << "Already in AMX allocation: " << amx_name;
-            ScopedValue<string> old_amx_name(amx_name, op->name + ".amx");
-            ScopedValue<string> old_tile_name(tile_name, op->name);
-            ScopedValue<bool> old_in_alloc(in_allocate, true);
             Stmt body = op->body;
-
-            pending_stores.clear();
-            body = mutate(body);
-            if (found_tile_x < 0 || found_tile_y < 0 || found_tile_r < 0) {
-                return op;
+            if (failure.empty()) {
+                pending_stores.clear();
+                body = mutate(body);
+                if (found_tile_x < 0 || found_tile_y < 0 || found_tile_r < 0) {
+                    fail("no matrix multiply of vectorized tiles was found");
+                }
             }
-            if (!pending_stores.empty()) {
+            if (failure.empty() && !pending_stores.empty()) {
                 // Really only need to go over the pending stores
+                ScopedValue<bool> old_in_pending(in_pending, true);
                 body = mutate(body);
             }
 
+            if (!failure.empty()) {
+                user_warning << "Can't use AMX instructions for " << op->name
+                             << " stored in MemoryType::AMXTile, because " << failure
+                             << ". Using MemoryType::Auto instead.\n";
+                return Allocate::make(op->name, op->type, MemoryType::Auto, op->extents, op->condition,
+                                      op->body, op->new_expr, op->free_function);
+            }
+
             auto alloc_type = amx_op_type_result_type(op_type);
-            return Allocate::make(amx_name, alloc_type, MemoryType::AMXTile, {1}, const_true(), body);
+            body = Allocate::make(amx_name, alloc_type, MemoryType::AMXTile, {1}, const_true(), body);
+            if (needs_epilogue) {
+                body = Allocate::make(op->name, op->type, MemoryType::Auto, op->extents, op->condition, body);
+            }
+            return body;
         }
         return IRMutator::visit(op);
     }
@@ -391,33 +555,75 @@ class ExtractTileOperations : public IRMutator {
     Expr visit(const Load *op) override {
         // Any tile load will be matched elsewhere, so a load here means that
         // the AMX tile is used outside of a tile instruction.
-        user_assert(op->name != tile_name) << "AMX tile allocation used outside a tile instruction";
+        if (op->name == tile_name) {
+            fail("it is used outside a tile instruction");
+        }
         return IRMutator::visit(op);
     }
 
     Stmt visit(const Store *op) override {
         if (op->name != tile_name) {
+            if (in_pending) {
+                // The consumers were already handled.
+                return op;
+            }
             const auto *load = op->value.as<Load>();
-            if (!load || load->name != tile_name) {
+            if (load && load->name == tile_name) {
+                auto store = convert_to_tile_store(amx_op_type_result_type(op_type), op->index, amx_name, op->name, found_tile_x, found_tile_y);
+                if (!store.defined()) {
+                    fail("it is copied to " + op->name + " in something other than a tile");
+                    return op;
+                }
+                return store;
+            }
+
+            FindLoads loads(tile_name);
+            op->value.accept(&loads);
+            if (loads.indices.empty()) {
+                return op;
+            }
+
+            // The consumer does more than copy the tile, e.g. it adds a bias
+            // or requantizes. Store the tile to the original allocation and
+            // leave the rest of it to the usual vector instructions.
+            Stmt store;
+            if (found_tile_x >= 0 && found_tile_y >= 0) {
+                const Expr &index = loads.indices[0];
+                bool same_index = true;
+                for (const Expr &e : loads.indices) {
+                    same_index = same_index && equal(e, index);
+                }
+                if (same_index) {
+                    // The consumer's type may differ from the
+                    // accumulator's, e.g. when it requantizes to uint8.
+                    store = convert_to_tile_store(amx_op_type_result_type(op_type), index, amx_name, tile_name, found_tile_x, found_tile_y);
+                }
+            }
+            if (!store.defined()) {
+                fail("it is used by " + op->name + " in something other than a tile");
                 return op;
             }
-            auto store = convert_to_tile_store(op, amx_name, found_tile_x, found_tile_y);
-            user_assert(store.defined()) << "Store to AMX tile allocation of a non-tile value";
-            return store;
+            needs_epilogue = true;
+            return Block::make(store, op);
         }
 
         auto matmul = convert_to_matmul(op, amx_name, op_type);
         if (matmul.result) {
-            user_assert(
-                (found_tile_x < 0 || matmul.tile_x == found_tile_x) &&
-                (found_tile_y < 0 || matmul.tile_y == found_tile_y) &&
-                (found_tile_r < 0 || matmul.tile_r == found_tile_r))
-                << "Found different tile sizes for AMX tile allocation";
+            if ((found_tile_x >= 0 && matmul.tile_x != found_tile_x) ||
+                (found_tile_y >= 0 && matmul.tile_y != found_tile_y) ||
+                (found_tile_r >= 0 && matmul.tile_r != found_tile_r)) {
+                fail("it has different tile sizes");
+                return op;
+            }
             found_tile_x = matmul.tile_x;
             found_tile_y = matmul.tile_y;
             found_tile_r = matmul.tile_r;
             return matmul.stmt;
         }
+        if (!matmul.failure.empty()) {
+            fail(matmul.failure);
+            return op;
+        }
 
         if (found_tile_x < 0 || found_tile_y < 0) {
             pending_stores.emplace_back(op);
@@ -429,16 +635,26 @@ class ExtractTileOperations : public IRMutator {
             return zero;
         }
 
+        auto init = convert_to_tile_load(op, found_tile_x, found_tile_y, amx_name);
+        if (init.defined()) {
+            return init;
+        }
+
         // Otherwise there is some other operation using the allocation, so we cannot use the AMX instructions
-        user_assert(false) << "Found non-tile operations for AMX tile allocation";
+        fail("it is stored to by something other than a tile instruction");
         return op;
     }
+
+public:
+    ExtractTileOperations(const Target &target)
+        : target(target) {
+    }
 };
 
 }  // namespace
 
-Stmt extract_tile_operations(const Stmt &s) {
-    return ExtractTileOperations().mutate(s);
+Stmt extract_tile_operations(const Stmt &s, const Target &t) {
+    return ExtractTileOperations(t).mutate(s);
 }
 }  // namespace Internal
 }  // namespace Halide
@@ -9,11 +9,18 @@
 #include "Expr.h"
 
 namespace Halide {
+
+struct Target;
+
 namespace Internal {
 
 /** Rewrite any AMX tile operations that have been stored in the AMXTile memory
- * type as intrinsic calls, to be used in the X86 backend. */
-Stmt extract_tile_operations(const Stmt &s);
+ * type as intrinsic calls, to be used in the X86 backend. A tile may be
+ * initialized with zero or with a load, such as of a bias, and its consumers
+ * may do more than copy it. If an allocation can't use AMX instructions, or
+ * the target doesn't have them, warn about why and use MemoryType::Auto
+ * instead. */
+Stmt extract_tile_operations(const Stmt &s, const Target &t);
 
 }  // namespace Internal
 }  // namespace Halide
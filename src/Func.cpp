@@ -1599,6 +1599,35 @@ Stage &Stage::tile(const std::vector<VarOrRVar> &previous,
     return tile(previous, previous, inners, factors, tail);
 }
 
+Stage &Stage::tile_recursive(const VarOrRVar &x, const VarOrRVar &y,
+                             const VarOrRVar &xo, const VarOrRVar &yo,
+                             const VarOrRVar &xi, const VarOrRVar &yi,
+                             const Expr &xleaf, const Expr &yleaf,
+                             int levels,
+                             TailStrategy tail) {
+    user_assert(levels >= 1)
+        << "In schedule for " << name() << ", tile_recursive requires at least one level\n";
+    split(x, x, xi, xleaf, tail);
+    split(y, y, yi, yleaf, tail);
+    // Peel off one bit of the leaf tile index at a time, lowest
+    // first. Interleaving the bits of x and y from innermost outwards
+    // gives a Z-order traversal of the leaf tiles.
+    split(x, x, xo, 2, TailStrategy::GuardWithIf);
+    split(y, y, yo, 2, TailStrategy::GuardWithIf);
+    std::vector<VarOrRVar> order = {xi, yi, xo, yo};
+    for (int i = 1; i < levels; i++) {
+        for (const VarOrRVar &v : {x, y}) {
+            VarOrRVar bit = v.is_rvar ? VarOrRVar(RVar()) : VarOrRVar(Var());
+            split(v, v, bit, 2, TailStrategy::GuardWithIf);
+            order.push_back(bit);
+        }
+    }
+    order.push_back(x);
+    order.push_back(y);
+    reorder(order);
+    return *this;
+}
+
 Stage &Stage::reorder(const std::vector<VarOrRVar> &vars) {
     const string &func_name = function.name();
     vector<Expr> &args = definition.args();
@@ -2165,6 +2194,17 @@ Func &Func::async() {
     return *this;
 }
 
+Func &Func::ring_buffer(Expr n) {
+    invalidate_cache();
+    Expr size = simplify(cast<int>(std::move(n)));
+    const int64_t *c = as_const_int(size);
+    user_assert(c && *c >= 1)
+        << "The ring_buffer size of Func " << name()
+        << " must be a positive constant, but is " << size << ".\n";
+    func.schedule().ring_buffer() = size;
+    return *this;
+}
+
 Stage Func::specialize(const Expr &c) {
     invalidate_cache();
     return Stage(func, func.definition(), 0).specialize(c);
@@ -2390,6 +2430,17 @@ Func &Func::tile(const std::vector<VarOrRVar> &previous,
     return *this;
 }
 
+Func &Func::tile_recursive(const VarOrRVar &x, const VarOrRVar &y,
+                           const VarOrRVar &xo, const VarOrRVar &yo,
+                           const VarOrRVar &xi, const VarOrRVar &yi,
+                           const Expr &xleaf, const Expr &yleaf,
+                           int levels,
+                           TailStrategy tail) {
+    invalidate_cache();
+    Stage(func, func.definition(), 0).tile_recursive(x, y, xo, yo, xi, yi, xleaf, yleaf, levels, tail);
+    return *this;
+}
+
 Func &Func::reorder(const std::vector<VarOrRVar> &vars) {
     invalidate_cache();
     Stage(func, func.definition(), 0).reorder(vars);
@@ -2702,6 +2753,24 @@ Func &Func::store_root() {
     return store_at(LoopLevel::root());
 }
 
+Func &Func::hoist_storage(LoopLevel loop_level) {
+    invalidate_cache();
+    func.schedule().hoist_storage_level() = std::move(loop_level);
+    return *this;
+}
+
+Func &Func::hoist_storage(const Func &f, const RVar &var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage(const Func &f, const Var &var) {
+    return hoist_storage(LoopLevel(f, var));
+}
+
+Func &Func::hoist_storage_root() {
+    return hoist_storage(LoopLevel::root());
+}
+
 Func &Func::compute_inline() {
     return compute_at(LoopLevel::inlined());
 }
@@ -372,6 +372,12 @@ public:
                 const std::vector<VarOrRVar> &inners,
                 const std::vector<Expr> &factors,
                 TailStrategy tail = TailStrategy::Auto);
+    Stage &tile_recursive(const VarOrRVar &x, const VarOrRVar &y,
+                          const VarOrRVar &xo, const VarOrRVar &yo,
+                          const VarOrRVar &xi, const VarOrRVar &yi,
+                          const Expr &xleaf, const Expr &yleaf,
+                          int levels = 6,
+                          TailStrategy tail = TailStrategy::Auto);
     Stage &reorder(const std::vector<VarOrRVar> &vars);
 
     template<typename... Args>
@@ -1565,6 +1571,35 @@ public:
                const std::vector<Expr> &factors,
                TailStrategy tail = TailStrategy::Auto);
 
+    /** Tile two dimensions in a cache-oblivious way. The domain is
+     * split into leaf tiles of size xleaf by yleaf, traversed by xi
+     * and yi, which can be vectorized or unrolled as usual. The grid of
+     * leaf tiles is then halved in each dimension 'levels' times, and
+     * the halves are visited in Z order. This is the traversal that
+     * recursively subdividing the domain down to the leaf size would
+     * give, so every level of the cache hierarchy sees tiles that fit
+     * it, without tuning tile sizes for a particular machine.
+     *
+     * xo and yo are the innermost level, which steps between adjacent
+     * leaf tiles, so compute_at(f, xo) computes a producer per leaf
+     * tile. The names x and y are reused for the outermost level,
+     * which covers blocks 2^levels leaf tiles on a side in row-major
+     * order, and can be parallelized. The tail strategy applies to the
+     * leaf tiles; partial halves are skipped with if statements. For
+     * example:
+     *
+     \code
+     f.tile_recursive(x, y, xo, yo, xi, yi, 8, 8).vectorize(xi).unroll(yi).parallel(y);
+     g.compute_at(f, xo);
+     \endcode
+     */
+    Func &tile_recursive(const VarOrRVar &x, const VarOrRVar &y,
+                         const VarOrRVar &xo, const VarOrRVar &yo,
+                         const VarOrRVar &xi, const VarOrRVar &yi,
+                         const Expr &xleaf, const Expr &yleaf,
+                         int levels = 6,
+                         TailStrategy tail = TailStrategy::Auto);
+
     /** Reorder variables to have the given nesting order, from
      * innermost out */
     Func &reorder(const std::vector<VarOrRVar> &vars);
@@ -2300,6 +2335,31 @@ public:
      */
     Func &async();
 
+    /** Let an async Func run up to n footprints ahead of its
+     * consumers. Storage folding of an async Func normally only
+     * leaves enough slack in the circular buffer for the producer to
+     * start on its next footprint while the consumer is finishing
+     * the current one. This multiplies the fold factor (automatic or
+     * explicit) by n, and initializes the semaphore coupling the
+     * producer and consumer to match, so that a chain of async stages
+     * with uneven costs can be software-pipelined n deep across
+     * cores. For example:
+     *
+     \code
+     f.store_root().compute_at(g, y).async().ring_buffer(2);
+     \endcode
+     *
+     * n must be a positive constant. Folded storage is indexed modulo
+     * the fold factor, which is a cheap mask when the factor is a power
+     * of two. Multiplying by an n that isn't a power of two makes it a
+     * general modulo on every access to the Func, so prefer 2 or 4 over
+     * 3 unless memory is tight.
+     *
+     * Has no effect if the storage of the Func is not folded, e.g. if
+     * it is stored at the same level it is computed at. Requires
+     * async(). */
+    Func &ring_buffer(Expr n);
+
     /** Bound the extent of a Func's storage, but not extent of its
      * compute. This can be useful for forcing a function's allocation 
      * to be a fixed size, which often means it can go on the stack. 
@@ -2416,6 +2476,46 @@ public:
      * outside the outermost loop. */
     Func &store_root();
 
+    /** Hoist the allocation of this Func out to the loop over a
+     * dimension of another Func, without changing where it is stored
+     * or computed. Unlike \ref Func::store_at, the region of this Func
+     * that is live at once doesn't grow: instead, a single buffer large
+     * enough for the largest region needed by any iteration of the
+     * loops between the hoist level and the store level is allocated
+     * once, and reused by each of those iterations. This avoids
+     * repeatedly allocating and freeing memory for Funcs computed
+     * inside tiles. For example:
+     *
+     \code
+     Func f, g;
+     Var x, y, xo, yo, xi, yi;
+     g(x, y) = x * y;
+     f(x, y) = g(x, y) + g(x + 1, y);
+     f.tile(x, y, xo, yo, xi, yi, 64, 64).parallel(yo);
+     g.compute_at(f, xo).hoist_storage(f, yo);
+     \endcode
+     *
+     * Here the storage for g is allocated once per row of tiles,
+     * rather than once per tile. Storage can't be hoisted outside of a
+     * parallel loop between the hoist level and the store level,
+     * because the iterations of that loop would share the buffer. The
+     * extents of the buffer must be bounded in terms of variables
+     * defined outside the hoist level. */
+    Func &hoist_storage(const Func &f, const Var &var);
+
+    /** Equivalent to the version of hoist_storage that takes a Var,
+     * but hoists the allocation to the loop over a dimension of a
+     * reduction domain */
+    Func &hoist_storage(const Func &f, const RVar &var);
+
+    /** Equivalent to the version of hoist_storage that takes a Var,
+     * but hoists the allocation to a given LoopLevel. */
+    Func &hoist_storage(LoopLevel loop_level);
+
+    /** Equivalent to \ref Func::hoist_storage, but hoists the
+     * allocation outside the outermost loop. */
+    Func &hoist_storage_root();
+
     /** Aggressively inline all uses of this function. This is the
      * default schedule, so you're unlikely to need to call this. For
      * a Func with an update definition, that means it gets computed
@@ -2260,6 +2260,8 @@ public:
     HALIDE_FORWARD_METHOD(Func, gpu_tile)
     HALIDE_FORWARD_METHOD_CONST(Func, has_update_definition)
     HALIDE_FORWARD_METHOD(Func, hexagon)
+    HALIDE_FORWARD_METHOD(Func, hoist_storage)
+    HALIDE_FORWARD_METHOD(Func, hoist_storage_root)
     HALIDE_FORWARD_METHOD(Func, in)
     HALIDE_FORWARD_METHOD(Func, memoize)
     HALIDE_FORWARD_METHOD_CONST(Func, num_update_definitions)
@@ -2271,6 +2273,7 @@ public:
     HALIDE_FORWARD_METHOD(Func, rename)
     HALIDE_FORWARD_METHOD(Func, reorder)
     HALIDE_FORWARD_METHOD(Func, reorder_storage)
+    HALIDE_FORWARD_METHOD(Func, ring_buffer)
     HALIDE_FORWARD_METHOD_CONST(Func, rvars)
     HALIDE_FORWARD_METHOD(Func, serial)
     HALIDE_FORWARD_METHOD(Func, set_estimate)
@@ -2280,6 +2283,7 @@ public:
     HALIDE_FORWARD_METHOD(Func, store_at)
     HALIDE_FORWARD_METHOD(Func, store_root)
     HALIDE_FORWARD_METHOD(Func, tile)
+    HALIDE_FORWARD_METHOD(Func, tile_recursive)
     HALIDE_FORWARD_METHOD(Func, trace_stores)
     HALIDE_FORWARD_METHOD(Func, unroll)
     HALIDE_FORWARD_METHOD(Func, update)
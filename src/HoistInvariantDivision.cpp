@@ -0,0 +1,243 @@
+#include "HoistInvariantDivision.h"
+
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Check if an expression is cheap to compute, and doesn't depend on
+// any of the given names.
+class IsInvariant : public IRVisitor {
+    const vector<string> &varying;
+
+    using IRVisitor::visit;
+
+    void visit(const Variable *op) override {
+        for (const string &v : varying) {
+            result = result && v != op->name;
+        }
+    }
+
+    void visit(const Load *op) override {
+        result = false;
+    }
+
+    void visit(const Call *op) override {
+        result = false;
+    }
+
+public:
+    bool result = true;
+
+    IsInvariant(const vector<string> &varying)
+        : varying(varying) {
+    }
+};
+
+// A scalar divisor used in a loop, and the prefix of the names of the
+// lets that hold its magic numbers.
+struct InvariantDivisor {
+    Expr divisor;
+    string name;
+};
+
+// Define the magic numbers for dividing by a divisor, using the
+// round-up method of Granlund and Montgomery on its absolute value.
+Stmt define_magic(const InvariantDivisor &d, Stmt s) {
+    Type t = d.divisor.type();
+    Type ut = t.with_code(Type::UInt);
+    Type wide = ut.widen();
+    const int bits = t.bits();
+
+    Expr abs_d = Variable::make(ut, d.name + ".abs");
+    Expr log2_d = Variable::make(ut, d.name + ".log2");
+
+    // Division by zero is zero, so the result is masked off.
+    Expr all_ones = t.is_int() ? make_const(t, -1) : t.max();
+    s = LetStmt::make(d.name + ".nonzero", select(d.divisor == make_zero(t), make_zero(t), all_ones), s);
+    if (t.is_int()) {
+        s = LetStmt::make(d.name + ".sign", d.divisor >> (bits - 1), s);
+    }
+    s = LetStmt::make(d.name + ".shift2", select(log2_d > 0, log2_d - 1, make_zero(ut)), s);
+    s = LetStmt::make(d.name + ".shift1", min(log2_d, 1), s);
+    Expr multiplier = ((((make_one(wide) << cast(wide, log2_d)) - cast(wide, abs_d)) << bits) /
+                       cast(wide, abs_d)) +
+                      1;
+    s = LetStmt::make(d.name + ".multiplier", cast(ut, multiplier), s);
+    s = LetStmt::make(d.name + ".log2", make_const(ut, bits) - count_leading_zeros(abs_d - 1), s);
+    s = LetStmt::make(d.name + ".abs", t.is_int() ? abs(d.divisor) : d.divisor, s);
+    return s;
+}
+
+class HoistInvariantDivision : public IRMutator {
+    // The variables that may change within the innermost loop.
+    vector<string> varying;
+
+    // The vector lets in scope that are a broadcast of a scalar.
+    Scope<Expr> broadcasts;
+
+    // The invariant divisors used in the innermost loop, if we're in
+    // a loop on the CPU.
+    vector<InvariantDivisor> *divisors = nullptr;
+
+    DeviceAPI device_api = DeviceAPI::Host;
+
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        DeviceAPI new_device_api =
+            op->device_api == DeviceAPI::None ? device_api : op->device_api;
+        ScopedValue<DeviceAPI> old_device_api(device_api, new_device_api);
+
+        vector<InvariantDivisor> loop_divisors;
+        vector<string> loop_varying{op->name};
+        ScopedValue<vector<InvariantDivisor> *> old_divisors(
+            divisors, device_api == DeviceAPI::Host ? &loop_divisors : nullptr);
+        std::swap(varying, loop_varying);
+        Stmt body = mutate(op->body);
+        std::swap(varying, loop_varying);
+
+        Stmt s = op;
+        if (!body.same_as(op->body)) {
+            s = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+        for (size_t i = loop_divisors.size(); i > 0; i--) {
+            s = define_magic(loop_divisors[i - 1], s);
+        }
+        return s;
+    }
+
+    template<typename LetOrLetStmt>
+    auto visit_let(const LetOrLetStmt *op) -> decltype(op->body) {
+        const Broadcast *bc = op->value.template as<Broadcast>();
+        auto body = op->body;
+        {
+            ScopedBinding<Expr> bind(bc != nullptr, broadcasts, op->name, bc ? bc->value : Expr());
+            varying.push_back(op->name);
+            body = mutate(op->body);
+            varying.pop_back();
+        }
+        Expr value = mutate(op->value);
+        if (value.same_as(op->value) && body.same_as(op->body)) {
+            return op;
+        }
+        return LetOrLetStmt::make(op->name, value, body);
+    }
+
+    Expr visit(const Let *op) override {
+        return visit_let(op);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        return visit_let(op);
+    }
+
+    // Get the scalar an invariant vector divisor is a broadcast of, or
+    // an undefined Expr if it isn't one.
+    Expr invariant_divisor(const Expr &b) {
+        Expr d;
+        if (const Broadcast *bc = b.as<Broadcast>()) {
+            d = bc->value;
+        } else if (const Variable *v = b.as<Variable>()) {
+            if (broadcasts.contains(v->name)) {
+                d = broadcasts.get(v->name);
+            }
+        }
+        if (!d.defined() || !d.type().is_scalar() || is_const(d)) {
+            return Expr();
+        }
+        IsInvariant check(varying);
+        d.accept(&check);
+        return check.result ? d : Expr();
+    }
+
+    Expr visit_div_or_mod(const Expr &e, const Expr &op_a, const Expr &op_b, bool is_div) {
+        Type t = e.type();
+        Expr d;
+        if (divisors && t.is_vector() && (t.is_int() || t.is_uint()) && t.bits() <= 32) {
+            d = invariant_divisor(op_b);
+        }
+        if (!d.defined()) {
+            return is_div ? IRMutator::visit(e.as<Div>()) : IRMutator::visit(e.as<Mod>());
+        }
+
+        string name;
+        for (const InvariantDivisor &i : *divisors) {
+            if (equal(i.divisor, d)) {
+                name = i.name;
+            }
+        }
+        if (name.empty()) {
+            name = unique_name('d');
+            divisors->push_back({d, name});
+        }
+
+        Type ut = t.with_code(Type::UInt);
+        const int bits = t.bits();
+        const int lanes = t.lanes();
+        auto magic = [&](const string &suffix, Type type) {
+            return Broadcast::make(Variable::make(type.element_of(), name + suffix), lanes);
+        };
+
+        // The numerator is used more than once.
+        Expr a_value = mutate(op_a);
+        Expr a = a_value;
+        string a_name;
+        if (!a.as<Variable>()) {
+            a_name = unique_name('t');
+            a = Variable::make(t, a_name);
+        }
+
+        // Divide the absolute value of the numerator, with negative
+        // numbers rounding towards negative infinity.
+        Expr num = a, sign;
+        if (t.is_int()) {
+            sign = a >> (bits - 1);
+            num = reinterpret(ut, a ^ sign);
+        }
+        Expr hi = cast(ut, (cast(ut.widen(), num) * cast(ut.widen(), magic(".multiplier", ut))) >> bits);
+        Expr q = (hi + ((num - hi) >> magic(".shift1", ut))) >> magic(".shift2", ut);
+        if (t.is_int()) {
+            Expr d_sign = magic(".sign", t);
+            q = reinterpret(t, q) ^ sign;
+            q = (q ^ d_sign) - d_sign;
+        }
+
+        Expr result;
+        if (is_div) {
+            result = q & magic(".nonzero", t);
+        } else {
+            result = (a - q * Broadcast::make(d, lanes)) & magic(".nonzero", t);
+        }
+        if (!a_name.empty()) {
+            result = Let::make(a_name, a_value, result);
+        }
+        return result;
+    }
+
+    Expr visit(const Div *op) override {
+        return visit_div_or_mod(op, op->a, op->b, true);
+    }
+
+    Expr visit(const Mod *op) override {
+        return visit_div_or_mod(op, op->a, op->b, false);
+    }
+};
+
+}  // namespace
+
+Stmt hoist_invariant_division(const Stmt &s) {
+    return HoistInvariantDivision().mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,29 @@
+#ifndef HALIDE_HOIST_INVARIANT_DIVISION_H
+#define HALIDE_HOIST_INVARIANT_DIVISION_H
+
+/** \file
+ * Defines the lowering pass that strength-reduces vector division by
+ * loop-invariant runtime values.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find vector divisions and modulos of 32-bit or narrower integers by
+ * a scalar that is not a constant, but does not change within the
+ * innermost loop containing them, such as a Param or a loop variable
+ * of an outer loop. No CPU has vector integer division, so these would
+ * otherwise be done one lane at a time. Instead, compute a
+ * multiply-and-shift magic number for the divisor once on entry to the
+ * loop, and divide using a widening multiply, some shifts, and an add
+ * in the loop, while preserving Halide's semantics for negative
+ * numbers and division by zero. Division by constants is handled in
+ * codegen instead. Must be run after vectorization. */
+Stmt hoist_invariant_division(const Stmt &s);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
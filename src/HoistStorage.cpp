@@ -0,0 +1,210 @@
+#include "HoistStorage.h"
+#include "Bounds.h"
+#include "ExprUsesVar.h"
+#include "Function.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Simplify.h"
+
+#include <utility>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::string;
+using std::vector;
+
+namespace {
+
+class HoistStorage : public IRMutator {
+    using IRMutator::visit;
+
+    // The hoist level of each allocation. Tuple-valued Funcs have
+    // been split into one allocation per tuple element by now.
+    map<string, LoopLevel> hoist_levels;
+
+    // The loops and lets entered so far, as intervals that may refer
+    // to the variables defined by the frames before them.
+    vector<std::pair<string, Interval>> frames;
+
+    struct Hoist {
+        // The index of the first frame inside the hoist level.
+        size_t first_frame;
+        // The hoisted allocation. Undefined extents mean the
+        // allocation hasn't been found yet.
+        Type type;
+        MemoryType memory_type = MemoryType::Auto;
+        vector<Expr> extents;
+        // The condition under which the allocation is needed at any
+        // of its sites.
+        Expr condition;
+    };
+    map<string, Hoist> hoists;
+
+    Stmt visit(const For *op) override {
+        vector<string> started = begin_hoists([&](const LoopLevel &l) { return l.match(op->name); });
+
+        bool track = !hoists.empty();
+        if (track) {
+            frames.emplace_back(op->name, Interval(op->min, op->min + op->extent - 1));
+        }
+        Stmt body = mutate(op->body);
+        if (track) {
+            frames.pop_back();
+        }
+
+        body = end_hoists(started, body);
+
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        bool track = !hoists.empty();
+        if (track) {
+            frames.emplace_back(op->name, op->value.type().is_int() ? Interval::single_point(op->value) : Interval::everything());
+        }
+        Stmt body = mutate(op->body);
+        if (track) {
+            frames.pop_back();
+        }
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return LetStmt::make(op->name, op->value, body);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        auto it = hoists.find(op->name);
+        if (it == hoists.end()) {
+            return IRMutator::visit(op);
+        }
+        Hoist &h = it->second;
+        internal_assert(!op->new_expr.defined() && op->free_function.empty())
+            << "Can't hoist custom allocation of " << op->name << "\n";
+
+        // Bound the extents over the loops and lets between the
+        // hoist level and here.
+        Scope<Interval> scope;
+        for (size_t i = h.first_frame; i < frames.size(); i++) {
+            const Interval &in = frames[i].second;
+            Interval min_bounds = bounds_of_expr_in_scope(in.min, scope);
+            Interval max_bounds = bounds_of_expr_in_scope(in.max, scope);
+            scope.push(frames[i].first, Interval(min_bounds.min, max_bounds.max));
+        }
+
+        // A conditional allocation can only be hoisted if its condition
+        // still makes sense at the hoist level. Otherwise leave it here.
+        if (!is_const_one(op->condition) && expr_uses_vars(op->condition, scope)) {
+            debug(3) << "Not hoisting allocation of " << op->name
+                     << " because its condition depends on the loops inside the hoist level\n";
+            return IRMutator::visit(op);
+        }
+
+        vector<Expr> extents;
+        for (const Expr &e : op->extents) {
+            Interval bounds = bounds_of_expr_in_scope(e, scope);
+            user_assert(bounds.has_upper_bound() && !expr_uses_vars(bounds.max, scope))
+                << "Can't hoist storage of " << op->name << " to " << hoist_levels.at(op->name).to_string()
+                << ", because the size of its allocation inside that loop is unbounded.\n";
+            extents.push_back(bounds.max);
+        }
+
+        if (h.extents.empty()) {
+            h.type = op->type;
+            h.memory_type = op->memory_type;
+            h.extents = extents;
+            h.condition = op->condition;
+        } else {
+            // The Func is stored at more than one site inside the
+            // hoist level. Allocate enough for the largest.
+            internal_assert(h.extents.size() == extents.size());
+            for (size_t i = 0; i < extents.size(); i++) {
+                h.extents[i] = max(h.extents[i], extents[i]);
+            }
+            h.condition = h.condition || op->condition;
+        }
+
+        return mutate(op->body);
+    }
+
+    // Start hoisting every allocation whose hoist level matches.
+    template<typename Fn>
+    vector<string> begin_hoists(Fn &&matches) {
+        vector<string> started;
+        for (const auto &p : hoist_levels) {
+            if (matches(p.second)) {
+                internal_assert(!hoists.count(p.first));
+                Hoist h;
+                h.first_frame = frames.size();
+                hoists.emplace(p.first, std::move(h));
+                started.push_back(p.first);
+            }
+        }
+        return started;
+    }
+
+    // Wrap the body of a hoist level in the allocations hoisted to it.
+    Stmt end_hoists(const vector<string> &started, Stmt body) {
+        for (const string &name : started) {
+            auto it = hoists.find(name);
+            internal_assert(it != hoists.end());
+            const Hoist &h = it->second;
+            if (!h.extents.empty()) {
+                vector<Expr> extents;
+                for (const Expr &e : h.extents) {
+                    extents.push_back(simplify(e));
+                }
+                debug(3) << "Hoisted allocation of " << name << " to " << hoist_levels.at(name).to_string() << "\n";
+                body = Allocate::make(name, h.type, h.memory_type, extents, simplify(h.condition), body);
+            }
+            hoists.erase(it);
+        }
+        return body;
+    }
+
+public:
+    HoistStorage(const map<string, Function> &env) {
+        for (const auto &p : env) {
+            const Function &f = p.second;
+            const LoopLevel &level = f.schedule().hoist_storage_level();
+            if (level.is_inlined()) {
+                continue;
+            }
+            if (f.outputs() == 1) {
+                hoist_levels.emplace(f.name(), level);
+            } else {
+                for (int i = 0; i < f.outputs(); i++) {
+                    hoist_levels.emplace(f.name() + "." + std::to_string(i), level);
+                }
+            }
+        }
+    }
+
+    bool any_hoisted() const {
+        return !hoist_levels.empty();
+    }
+
+    Stmt hoist_to_root(const Stmt &s) {
+        vector<string> started = begin_hoists([&](const LoopLevel &l) { return l.is_root(); });
+        Stmt body = mutate(s);
+        return end_hoists(started, body);
+    }
+};
+
+}  // namespace
+
+Stmt hoist_storage(const Stmt &s, const map<string, Function> &env) {
+    HoistStorage hoister(env);
+    if (!hoister.any_hoisted()) {
+        return s;
+    }
+    return hoister.hoist_to_root(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,30 @@
+#ifndef HALIDE_HOIST_STORAGE_H
+#define HALIDE_HOIST_STORAGE_H
+
+/** \file
+ * Defines the lowering pass that hoists allocations out to the loop
+ * level given by Func::hoist_storage.
+ */
+
+#include <map>
+#include <string>
+
+#include "Expr.h"
+
+namespace Halide {
+namespace Internal {
+
+class Function;
+
+/** Move the allocation of each Func with a hoist_storage level out to
+ * the top of the body of that loop (or outside all loops, for
+ * hoist_storage_root). The extents of the hoisted allocation are the
+ * upper bounds of the original extents over all iterations of the
+ * loops it was moved out of, so that one buffer can be reused by all
+ * of them. Must be run after storage flattening. */
+Stmt hoist_storage(const Stmt &s, const std::map<std::string, Function> &env);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
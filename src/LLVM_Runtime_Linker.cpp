@@ -1,6 +1,7 @@
 #include "LLVM_Runtime_Linker.h"
 #include "Error.h"
 #include "LLVM_Headers.h"
+#include "MultiversionLoops.h"
 #include "Target.h"
 
 namespace Halide {
@@ -270,11 +271,15 @@ DECLARE_NO_INITMOD(hexagon_cpu_features)
 #endif  // WITH_HEXAGON
 
 #ifdef WITH_WEBASSEMBLY
+DECLARE_LL_INITMOD(wasm_atomics)
 DECLARE_CPP_INITMOD(wasm_cpu_features)
 DECLARE_LL_INITMOD(wasm_math)
+DECLARE_CPP_INITMOD(wasm_threads)
 #else
+DECLARE_NO_INITMOD(wasm_atomics)
 DECLARE_NO_INITMOD(wasm_cpu_features)
 DECLARE_NO_INITMOD(wasm_math)
+DECLARE_NO_INITMOD(wasm_threads)
 #endif  // WITH_WEBASSEMBLY
 
 #ifdef WITH_RISCV
@@ -847,8 +852,10 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
                 modules.push_back(get_initmod_linux_host_cpu_count(c, bits_64, debug));
                 modules.push_back(get_initmod_linux_yield(c, bits_64, debug));
                 if (t.has_feature(Target::WasmThreads)) {
-                    // Assume that the wasm libc will be providing pthreads
-                    modules.push_back(get_initmod_posix_threads(c, bits_64, debug));
+                    // Assume that the wasm libc will be providing pthreads,
+                    // but park and unpark the workers with wasm atomics.
+                    modules.push_back(get_initmod_wasm_threads(c, bits_64, debug));
+                    modules.push_back(get_initmod_wasm_atomics_ll(c));
                 } else {
                     modules.push_back(get_initmod_fake_thread_pool(c, bits_64, debug));
                 }
@@ -1054,16 +1061,38 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             } else {
                 modules.push_back(get_initmod_prefetch(c, bits_64, debug));
             }
-            if (t.has_feature(Target::SSE41)) {
+            // Multiversioned loops may use the helpers of any of the
+            // feature levels they are compiled for.
+            Target x86_target = t;
+            for (const MultiversionLevel &level : get_multiversion_levels(t)) {
+                x86_target.set_features(level.features);
+            }
+            // Add the features implied by the ones the target has, as
+            // CodeGen_X86 does, because the helpers of a newer feature
+            // may live in the module of the older one.
+            if (x86_target.features_any_of({Target::AVX512_KNL, Target::AVX512_Skylake,
+                                            Target::AVX512_Cannonlake, Target::AVX512_SapphireRapids})) {
+                x86_target.set_feature(Target::AVX512);
+            }
+            if (x86_target.features_any_of({Target::AVX512, Target::AVXVNNI})) {
+                x86_target.set_feature(Target::AVX2);
+            }
+            if (x86_target.has_feature(Target::AVX2)) {
+                x86_target.set_feature(Target::AVX);
+            }
+            if (x86_target.has_feature(Target::AVX)) {
+                x86_target.set_feature(Target::SSE41);
+            }
+            if (x86_target.has_feature(Target::SSE41)) {
                 modules.push_back(get_initmod_x86_sse41_ll(c));
             }
-            if (t.has_feature(Target::AVX)) {
+            if (x86_target.has_feature(Target::AVX)) {
                 modules.push_back(get_initmod_x86_avx_ll(c));
             }
-            if (t.has_feature(Target::AVX2)) {
+            if (x86_target.has_feature(Target::AVX2)) {
                 modules.push_back(get_initmod_x86_avx2_ll(c));
             }
-            if (t.has_feature(Target::AVX512)) {
+            if (x86_target.has_feature(Target::AVX512)) {
                 modules.push_back(get_initmod_x86_avx512_ll(c));
             }
             if (t.has_feature(Target::AVX512_SapphireRapids)) {
@@ -1078,8 +1107,10 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             }
         }
 
-        if (module_type == ModuleAOT) {
-            // These modules are only used for AOT compilation
+        if (module_type == ModuleAOT ||
+            (module_type == ModuleJITInlined && !get_multiversion_levels(t).empty())) {
+            // These modules are only used for AOT compilation, and to
+            // dispatch multiversioned loops.
             modules.push_back(get_initmod_can_use_target(c, bits_64, debug));
             if (t.arch == Target::X86) {
                 modules.push_back(get_initmod_x86_cpu_features(c, bits_64, debug));
@@ -32,6 +32,8 @@
 #include "FuseGPUThreadLoops.h"
 #include "FuzzFloatStores.h"
 #include "HexagonOffload.h"
+#include "HoistInvariantDivision.h"
+#include "HoistStorage.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "IRPrinter.h"
@@ -43,10 +45,12 @@
 #include "LowerParallelTasks.h"
 #include "LowerWarpShuffles.h"
 #include "Memoization.h"
+#include "MultiversionLoops.h"
 #include "OffloadGPULoops.h"
 #include "PartitionLoops.h"
 #include "Prefetch.h"
 #include "Profiling.h"
+#include "PromoteRegisterTiles.h"
 #include "PurifyIndexMath.h"
 #include "Qualify.h"
 #include "RealizationOrder.h"
@@ -61,6 +65,7 @@
 #include "SimplifySpecializations.h"
 #include "SkipStages.h"
 #include "SlidingWindow.h"
+#include "SpecializeDenseBuffers.h"
 #include "SplitTuples.h"
 #include "StorageFlattening.h"
 #include "StorageFolding.h"
@@ -267,6 +272,10 @@ void lower_impl(const vector<Function> &output_funcs,
     s = storage_flattening(s, outputs, env, t);
     log("Lowering after storage flattening:", s);
 
+    debug(1) << "Hoisting storage...\n";
+    s = hoist_storage(s, env);
+    log("Lowering after hoisting storage:", s);
+
     debug(1) << "Adding atomic mutex allocation...\n";
     s = add_atomic_mutex(s, env);
     log("Lowering after adding atomic mutex allocation:", s);
@@ -275,6 +284,12 @@ void lower_impl(const vector<Function> &output_funcs,
     s = unpack_buffers(s);
     log("Lowering after unpacking buffer arguments:", s);
 
+    if (t.has_feature(Target::SpecializeDenseBuffers) && !t.has_gpu_feature()) {
+        debug(1) << "Specializing for dense and aligned buffers...\n";
+        s = specialize_dense_buffers(s, t);
+        log("Lowering after specializing for dense and aligned buffers:", s);
+    }
+
     if (any_memoized) {
         debug(1) << "Rewriting memoized allocations...\n";
         s = rewrite_memoized_allocations(s, env);
@@ -345,6 +360,12 @@ void lower_impl(const vector<Function> &output_funcs,
     debug(2) << "Lowering after rebasing loops to zero:\n"
              << s << "\n\n";
 
+    if (t.has_feature(Target::AutoPrefetch)) {
+        debug(1) << "Injecting automatic prefetches...\n";
+        s = inject_auto_prefetch(s, t);
+        log("Lowering after injecting automatic prefetches:", s);
+    }
+
     debug(1) << "Hoisting loop invariant if statements...\n";
     s = hoist_loop_invariant_if_statements(s);
     log("Lowering after hoisting loop invariant if statements:", s);
@@ -367,6 +388,10 @@ void lower_impl(const vector<Function> &output_funcs,
     s = bound_small_allocations(s);
     log("Lowering after bounding small allocations:", s);
 
+    debug(1) << "Promoting register tiles...\n";
+    s = promote_register_tiles(s, t);
+    log("Lowering after promoting register tiles:", s);
+
     if (t.has_feature(Target::Profile)) {
         debug(1) << "Injecting profiling...\n";
         s = inject_profiling(s, pipeline_name);
@@ -386,16 +411,18 @@ void lower_impl(const vector<Function> &output_funcs,
     s = lower_unsafe_promises(s, t);
     log("Lowering after lowering unsafe promises:", s);
 
-    if (t.has_feature(Target::AVX512_SapphireRapids)) {
-        debug(1) << "Extracting tile operations...\n";
-        s = extract_tile_operations(s);
-        log("Lowering after extracting tile operations:", s);
-    }
+    debug(1) << "Extracting tile operations...\n";
+    s = extract_tile_operations(s, t);
+    log("Lowering after extracting tile operations:", s);
 
     debug(1) << "Flattening nested ramps...\n";
     s = flatten_nested_ramps(s);
     log("Lowering after flattening nested ramps:", s);
 
+    debug(1) << "Hoisting division by loop invariant values...\n";
+    s = hoist_invariant_division(s);
+    log("Lowering after hoisting division by loop invariant values:", s);
+
     debug(1) << "Removing dead allocations and moving loop invariant code...\n";
     s = remove_dead_allocations(s);
     s = simplify(s);
@@ -453,6 +480,12 @@ void lower_impl(const vector<Function> &output_funcs,
     vector<InferredArgument> inferred_args = infer_arguments(s, outputs);
 
     std::vector<LoweredFunc> closure_implementations;
+    if (!get_multiversion_levels(t).empty()) {
+        debug(1) << "Multiversioning vector loops...\n";
+        s = multiversion_loops(s, closure_implementations, pipeline_name, t);
+        log("Lowering after multiversioning vector loops:", s);
+    }
+
     debug(1) << "Lowering Parallel Tasks...\n";
     s = lower_parallel_tasks(s, closure_implementations, pipeline_name, t);
     // Process any LoweredFunctions added by other passes. In practice, this
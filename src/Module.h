@@ -110,6 +110,12 @@ struct LoweredFunc {
      * the Target. */
     NameMangling name_mangling;
 
+    /** Target features to compile the body of this function with, in
+     * addition to those of the Module's target. Used for the copies of
+     * loops made by multiversion_loops. Backends that can't change the
+     * target per function ignore this. */
+    std::vector<Target::Feature> extra_features;
+
     LoweredFunc(const std::string &name,
                 const std::vector<LoweredArgument> &args,
                 Stmt body,
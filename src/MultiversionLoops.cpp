@@ -0,0 +1,222 @@
+#include "MultiversionLoops.h"
+
+#include "Closure.h"
+#include "Debug.h"
+#include "DebugArguments.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+LoweredArgument make_scalar_arg(const string &name, const Type &type) {
+    return LoweredArgument(name, Argument::Kind::InputScalar, type, 0, ArgumentEstimates());
+}
+
+// Check if a loop body is worth multiversioning, and can be moved into
+// a function of its own: it does vector math, and it has no loops,
+// allocations, or tasks of its own.
+class IsHotVectorLoopBody : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const For *op) override {
+        result = false;
+    }
+
+    void visit(const Allocate *op) override {
+        result = false;
+    }
+
+    void visit(const Fork *op) override {
+        result = false;
+    }
+
+    void visit(const Acquire *op) override {
+        result = false;
+    }
+
+    void visit(const Ramp *op) override {
+        has_vectors = true;
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Broadcast *op) override {
+        has_vectors = true;
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool result = true;
+    bool has_vectors = false;
+};
+
+// An expression that is true if the CPU running the pipeline has all
+// of the given features.
+Expr can_use_features(const vector<Target::Feature> &features) {
+    constexpr int kFeaturesWordCount = (Target::FeatureEnd + 63) / (sizeof(uint64_t) * 8);
+    uint64_t words[kFeaturesWordCount] = {0};
+    for (Target::Feature f : features) {
+        words[f >> 6] |= ((uint64_t)1) << (f & 63);
+    }
+    vector<Expr> features_struct_args;
+    for (uint64_t word : words) {
+        features_struct_args.emplace_back(UIntImm::make(UInt(64), word));
+    }
+    Expr can_use = Call::make(Int(32), "halide_can_use_target_features",
+                              {kFeaturesWordCount, Call::make(type_of<uint64_t *>(), Call::make_struct, features_struct_args, Call::Intrinsic)},
+                              Call::Extern);
+    return can_use != 0;
+}
+
+class MultiversionLoops : public IRMutator {
+    using IRMutator::visit;
+
+    // Loops nested inside a GPU kernel or an offloaded loop have
+    // DeviceAPI::None, so track the device of the enclosing loops.
+    DeviceAPI device_api = DeviceAPI::Host;
+
+    Stmt visit(const For *op) override {
+        DeviceAPI new_device_api =
+            op->device_api == DeviceAPI::None ? device_api : op->device_api;
+        ScopedValue<DeviceAPI> old_device_api(device_api, new_device_api);
+        if (op->for_type != ForType::Serial || device_api != DeviceAPI::Host) {
+            return IRMutator::visit(op);
+        }
+        IsHotVectorLoopBody check;
+        op->body.accept(&check);
+        if (!check.result || !check.has_vectors) {
+            return IRMutator::visit(op);
+        }
+
+        Closure closure;
+        closure.include(op);
+
+        // The same name can appear as a var and a buffer. Remove the var name in this case.
+        for (auto const &b : closure.buffers) {
+            closure.vars.erase(b.first);
+        }
+
+        const string closure_name = unique_name("multiversion_closure");
+        const string closure_arg_name = unique_name("closure_arg");
+        Expr closure_struct_allocation = closure.pack_into_struct();
+        Expr closure_arg_var = Variable::make(closure_struct_allocation.type(), closure_arg_name);
+        Stmt wrapped_body = closure.unpack_from_struct(closure_arg_var, op);
+
+        const vector<LoweredArgument> closure_args = {
+            make_scalar_arg("__user_context", type_of<void *>()),
+            make_scalar_arg(closure_arg_name, type_of<uint8_t *>()),
+        };
+
+        // Make a copy of the loop for each feature level, and one for
+        // the target itself, which always works.
+        const string base_name = c_print_name(unique_name(function_name + ".vec_for." + op->name), false);
+        vector<Expr> dispatch_args;
+        for (const MultiversionLevel &level : levels) {
+            LoweredFunc f{base_name + "_" + level.suffix, closure_args, wrapped_body, LinkageType::External, NameMangling::C};
+            f.extra_features = level.features;
+            add_function(std::move(f));
+            dispatch_args.push_back(can_use_features(level.features));
+            dispatch_args.emplace_back(base_name + "_" + level.suffix);
+        }
+        add_function(LoweredFunc{base_name, closure_args, wrapped_body, LinkageType::External, NameMangling::C});
+        dispatch_args.push_back(const_true());
+        dispatch_args.emplace_back(base_name);
+
+        // The dispatcher picks a copy the first time it is called, and
+        // calls the same one from then on.
+        const string dispatch_name = base_name + "_dispatch";
+        {
+            Expr result = Call::make(Int(32), Call::call_cached_indirect_function, dispatch_args, Call::Intrinsic);
+            const string result_name = unique_name("multiversion_result");
+            Expr result_var = Variable::make(Int(32), result_name);
+            Stmt body = AssertStmt::make(result_var == 0, result_var);
+            body = LetStmt::make(result_name, result, body);
+            add_function(LoweredFunc{dispatch_name, closure_args, body, LinkageType::External, NameMangling::C});
+        }
+
+        Expr user_context = Call::make(type_of<void *>(), Call::get_user_context, {}, Call::PureIntrinsic);
+        Expr closure_struct_arg = Cast::make(type_of<uint8_t *>(), Variable::make(Handle(), closure_name));
+        Expr result = Call::make(Int(32), dispatch_name, {user_context, closure_struct_arg}, Call::Extern);
+        const string result_name = unique_name("multiversion_result");
+        Expr result_var = Variable::make(Int(32), result_name);
+        Stmt stmt = AssertStmt::make(result_var == 0, result_var);
+        stmt = LetStmt::make(result_name, result, stmt);
+        stmt = LetStmt::make(closure_name, closure_struct_allocation, stmt);
+        return stmt;
+    }
+
+    void add_function(LoweredFunc f) {
+        if (target.has_feature(Target::Debug)) {
+            debug_arguments(&f, target);
+        }
+        closure_implementations.emplace_back(std::move(f));
+    }
+
+public:
+    MultiversionLoops(const string &name, const Target &t)
+        : function_name(name), target(t), levels(get_multiversion_levels(t)) {
+    }
+
+    string function_name;
+    const Target &target;
+    vector<MultiversionLevel> levels;
+    vector<LoweredFunc> closure_implementations;
+};
+
+}  // namespace
+
+vector<MultiversionLevel> get_multiversion_levels(const Target &t) {
+    vector<MultiversionLevel> result;
+    if (t.arch != Target::X86 || !t.has_feature(Target::Multiversion)) {
+        return result;
+    }
+
+    const vector<Target::Feature> sse41 = {Target::SSE41};
+    vector<Target::Feature> avx2 = sse41;
+    avx2.insert(avx2.end(), {Target::AVX, Target::AVX2, Target::FMA, Target::F16C});
+    vector<Target::Feature> avx512 = avx2;
+    avx512.insert(avx512.end(), {Target::AVX512, Target::AVX512_Skylake});
+
+    // Like get_host_target, only use AVX-512 in 64-bit code.
+    if (t.bits == 64 && !t.features_all_of(avx512)) {
+        result.push_back({"avx512", avx512});
+    }
+    if (!t.features_all_of(avx2)) {
+        result.push_back({"avx2", avx2});
+    }
+    if (!t.features_all_of(sse41)) {
+        result.push_back({"sse41", sse41});
+    }
+    return result;
+}
+
+Stmt multiversion_loops(const Stmt &s, vector<LoweredFunc> &closure_implementations,
+                        const string &name, const Target &t) {
+    MultiversionLoops mutator(name, t);
+    if (mutator.levels.empty()) {
+        return s;
+    }
+    Stmt result = mutator.mutate(s);
+
+    if (debug::debug_level() >= 2) {
+        for (const auto &lf : mutator.closure_implementations) {
+            debug(2) << "multiversion_loops generated lowered function " << lf.name << ":\n"
+                     << lf.body << "\n\n";
+        }
+    }
+
+    closure_implementations.insert(closure_implementations.end(),
+                                   mutator.closure_implementations.begin(),
+                                   mutator.closure_implementations.end());
+    return result;
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,51 @@
+#ifndef HALIDE_MULTIVERSION_LOOPS_H
+#define HALIDE_MULTIVERSION_LOOPS_H
+
+/** \file
+ * Defines the lowering pass that compiles the vector loops of an x86
+ * pipeline for several feature levels, and picks one at runtime.
+ */
+
+#include <string>
+#include <vector>
+
+#include "Expr.h"
+#include "Module.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+/** An x86 feature level that loops are multiversioned for. */
+struct MultiversionLevel {
+    /** Appended to the names of the functions compiled for this level. */
+    std::string suffix;
+
+    /** All the features of this level, including the implied ones. */
+    std::vector<Target::Feature> features;
+};
+
+/** The feature levels, best first, that the loops of a pipeline
+ * compiled for the given target are also compiled for: AVX-512
+ * (Skylake), AVX2 with FMA and F16C, and SSE4.1, minus those the
+ * target already has all the features of. Empty unless the target is
+ * x86 and has Target::Multiversion. */
+std::vector<MultiversionLevel> get_multiversion_levels(const Target &t);
+
+/** Move each innermost serial loop that does vector math on the host
+ * into its own function, and compile a copy of that function for each
+ * of the feature levels given by get_multiversion_levels, plus one for
+ * the target itself. The loop is replaced by a call to a dispatcher
+ * that tests the CPU with halide_can_use_target_features on first use,
+ * caches the best copy it can run, and calls it. This gets most of the
+ * speed of compiling the whole pipeline for each target, without
+ * duplicating all of the code outside the hot loops. The functions are
+ * appended to closure_implementations. Must be run after
+ * infer_arguments and before lower_parallel_tasks. */
+Stmt multiversion_loops(const Stmt &s, std::vector<LoweredFunc> &closure_implementations,
+                        const std::string &name, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
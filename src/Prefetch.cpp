@@ -6,11 +6,13 @@
 #include "Bounds.h"
 #include "ExprUsesVar.h"
 #include "Function.h"
+#include "IREquality.h"
 #include "IRMutator.h"
 #include "IROperator.h"
 #include "Prefetch.h"
 #include "Scope.h"
 #include "Simplify.h"
+#include "Substitute.h"
 #include "Target.h"
 #include "Util.h"
 
@@ -430,6 +432,236 @@ class HoistPrefetches : public IRMutator {
     }
 };
 
+// A rough model of the memory system of a target, used to decide
+// which access streams to prefetch automatically, and how far ahead.
+struct MemoryModel {
+    // Bytes per cache line.
+    int cache_line_size;
+    // Cycles to service a load that misses in all caches.
+    int miss_latency;
+    // The largest stride, in bytes, that the hardware prefetcher
+    // follows. Streams with larger strides (or strides unknown at
+    // compile time, which are usually the stride of an outer
+    // dimension) are always prefetched.
+    int max_hardware_stride;
+    // The number of concurrent streams the hardware prefetcher can
+    // track. Loops with more streams than this get all of their
+    // streams prefetched.
+    int max_hardware_streams;
+    // Instructions retired per cycle, to turn the size of a loop body
+    // into a time.
+    int issue_width;
+};
+
+MemoryModel get_memory_model(const Target &t) {
+    if (t.arch == Target::X86) {
+        // The L1 IP-stride prefetcher follows strides of up to 2KB,
+        // and the L2 streamer tracks 16 forward streams.
+        return {64, 250, 2048, 16, 4};
+    } else if (t.arch == Target::ARM) {
+        return {64, 200, 2048, 8, 3};
+    } else {
+        return {64, 200, 1024, 8, 2};
+    }
+}
+
+// Find the loads and stores in the body of a loop whose address
+// advances by a fixed amount per iteration, and estimate how many
+// instructions an iteration takes.
+class FindAccessStreams : public IRGraphVisitor {
+public:
+    struct Stream {
+        string name;
+        Type type;
+        // The index of the first element accessed, and how much it
+        // advances per iteration of the loop.
+        Expr base, stride;
+    };
+    vector<Stream> streams;
+
+    bool has_inner_loop = false;
+    int ops = 0;
+
+    FindAccessStreams(const string &loop_var, const Scope<> &local_allocations, int cache_line_size)
+        : loop_var(loop_var), local_allocations(local_allocations), cache_line_size(cache_line_size) {
+    }
+
+private:
+    const string &loop_var;
+    const Scope<> &local_allocations;
+    const int cache_line_size;
+    // Variables defined inside the loop body. Addresses that depend
+    // on them can't be computed ahead of time at the top of the loop.
+    Scope<> inner_vars;
+
+    using IRGraphVisitor::visit;
+
+    void include(const Expr &e) override {
+        if (!e.as<Variable>() && !is_const(e)) {
+            ops++;
+        }
+        IRGraphVisitor::include(e);
+    }
+
+    void visit(const For *op) override {
+        has_inner_loop = true;
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const Let *op) override {
+        inner_vars.push(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void visit(const LetStmt *op) override {
+        inner_vars.push(op->name);
+        IRGraphVisitor::visit(op);
+    }
+
+    void add_access(const string &name, Type type, const Expr &index) {
+        if (local_allocations.contains(name)) {
+            return;
+        }
+        Expr base = index;
+        if (const Ramp *r = index.as<Ramp>()) {
+            base = r->base;
+        }
+        if (base.type().is_vector() ||
+            !expr_uses_var(base, loop_var) ||
+            expr_uses_vars(base, inner_vars)) {
+            return;
+        }
+        Expr stride = simplify(substitute(loop_var, Variable::make(Int(32), loop_var) + 1, base) - base);
+        if (expr_uses_var(stride, loop_var)) {
+            // Not an affine function of the loop variable.
+            return;
+        }
+        // Accesses that land on the same cache line as an existing
+        // stream every iteration are part of that stream.
+        const int lanes_per_line = std::max(1, cache_line_size / type.bytes());
+        for (const Stream &s : streams) {
+            if (s.name == name && equal(s.stride, stride)) {
+                const int64_t *delta = as_const_int(simplify(base - s.base));
+                if (delta && *delta > -lanes_per_line && *delta < lanes_per_line) {
+                    return;
+                }
+            }
+        }
+        streams.push_back({name, type.element_of(), base, stride});
+    }
+
+    void visit(const Load *op) override {
+        IRGraphVisitor::visit(op);
+        add_access(op->name, op->type, op->index);
+    }
+
+    void visit(const Store *op) override {
+        IRGraphVisitor::visit(op);
+        add_access(op->name, op->value.type(), op->index);
+    }
+};
+
+// Add prefetches to innermost loops for the access streams that the
+// hardware prefetcher is likely to miss.
+class InjectAutoPrefetch : public IRMutator {
+    const MemoryModel model;
+
+    // Allocations in fast memory, or small enough to stay in cache,
+    // which are never prefetched.
+    Scope<> local_allocations;
+
+    using IRMutator::visit;
+
+    Stmt visit(const Allocate *op) override {
+        const int small_allocation_size = 16 * 1024;
+        int32_t size = op->constant_allocation_size();
+        if ((size > 0 && (int64_t)size * op->type.bytes() <= small_allocation_size) ||
+            op->memory_type == MemoryType::Stack ||
+            op->memory_type == MemoryType::Register ||
+            op->memory_type == MemoryType::LockedCache ||
+            op->memory_type == MemoryType::VTCM ||
+            op->memory_type == MemoryType::AMXTile) {
+            ScopedBinding<> bind(local_allocations, op->name);
+            return IRMutator::visit(op);
+        } else {
+            return IRMutator::visit(op);
+        }
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->device_api != DeviceAPI::None &&
+            op->device_api != DeviceAPI::Host) {
+            // Leave device code alone.
+            return op;
+        }
+
+        Stmt body = mutate(op->body);
+        Stmt prefetches = prefetch_streams(op, body);
+        if (prefetches.defined()) {
+            body = Block::make(prefetches, body);
+        }
+
+        if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, std::move(body));
+        }
+    }
+
+    Stmt prefetch_streams(const For *op, const Stmt &body) {
+        FindAccessStreams finder(op->name, local_allocations, model.cache_line_size);
+        body.accept(&finder);
+        if (finder.has_inner_loop ||
+            op->for_type != ForType::Serial ||
+            finder.streams.empty()) {
+            return Stmt();
+        }
+
+        // Fetch far enough ahead to cover the miss latency.
+        const int cycles_per_iteration = std::max(1, finder.ops / model.issue_width);
+        const int distance = std::min(64, (model.miss_latency + cycles_per_iteration - 1) / cycles_per_iteration);
+        const int64_t *const_extent = as_const_int(op->extent);
+        if (const_extent && *const_extent <= distance) {
+            // Too short for the prefetches to land in time.
+            return Stmt();
+        }
+
+        int num_short_strides = 0;
+        vector<bool> is_long_stride;
+        for (const auto &s : finder.streams) {
+            const int64_t *stride = as_const_int(simplify(s.stride * s.type.bytes()));
+            is_long_stride.push_back(!stride || std::abs(*stride) > model.max_hardware_stride);
+            num_short_strides += !is_long_stride.back();
+        }
+        const bool too_many_streams = num_short_strides > model.max_hardware_streams;
+
+        // Clamp the iteration prefetched from to the end of the loop.
+        Expr loop_var = Variable::make(Int(32), op->name);
+        Expr ahead = Min::make(loop_var + distance, op->min + op->extent - 1);
+        Stmt prefetches;
+        for (size_t i = 0; i < finder.streams.size(); i++) {
+            const auto &s = finder.streams[i];
+            if (!is_long_stride[i] && !too_many_streams) {
+                continue;
+            }
+            debug(3) << "Prefetching " << s.name << " " << distance
+                     << " iterations ahead in loop " << op->name
+                     << " with stride " << s.stride << "\n";
+            Expr base = Variable::make(Handle(), s.name);
+            Expr offset = simplify(substitute(op->name, ahead, s.base));
+            Expr stride = std::max(1, model.cache_line_size / s.type.bytes());
+            Stmt p = Evaluate::make(Call::make(s.type, Call::prefetch, {base, offset, 1, stride}, Call::Intrinsic));
+            prefetches = prefetches.defined() ? Block::make(prefetches, p) : p;
+        }
+        return prefetches;
+    }
+
+public:
+    InjectAutoPrefetch(const Target &t)
+        : model(get_memory_model(t)) {
+    }
+};
+
 }  // anonymous namespace
 
 Stmt inject_placeholder_prefetch(const Stmt &s, const map<string, Function> &env,
@@ -477,5 +709,15 @@ Stmt hoist_prefetches(const Stmt &s) {
     return HoistPrefetches().mutate(s);
 }
 
+Stmt inject_auto_prefetch(const Stmt &s, const Target &t) {
+    if (t.arch == Target::Hexagon ||
+        t.arch == Target::WebAssembly) {
+        // Hexagon prefetches are of whole regions, and wasm has no
+        // prefetch instruction.
+        return s;
+    }
+    return InjectAutoPrefetch(t).mutate(s);
+}
+
 }  // namespace Internal
 }  // namespace Halide
@@ -47,6 +47,15 @@ Stmt reduce_prefetch_dimension(Stmt stmt, const Target &t);
  * and may need revisiting.) See also https://bugs.llvm.org/show_bug.cgi?id=51172 */
 Stmt hoist_prefetches(const Stmt &s);
 
+/** Inject prefetches into innermost loops for the strided streams of
+ * loads and stores that the hardware prefetcher of the target is
+ * unlikely to cover: those with strides too large for it to follow
+ * (or unknown at compile time), or all of them if there are more
+ * streams than it can track. The prefetch distance is the number of
+ * iterations needed to cover the miss latency, estimated from the size
+ * of the loop body. Enabled by Target::AutoPrefetch. */
+Stmt inject_auto_prefetch(const Stmt &s, const Target &t);
+
 }  // namespace Internal
 }  // namespace Halide
 
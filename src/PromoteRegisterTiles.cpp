@@ -0,0 +1,238 @@
+#include "PromoteRegisterTiles.h"
+
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "IRVisitor.h"
+#include "Scope.h"
+#include "Target.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// The number of vector registers available on the target.
+int vector_register_count(const Target &t) {
+    switch (t.arch) {
+    case Target::X86:
+        if (t.has_feature(Target::AVX512) ||
+            t.has_feature(Target::AVX512_KNL) ||
+            t.has_feature(Target::AVX512_Skylake) ||
+            t.has_feature(Target::AVX512_Cannonlake) ||
+            t.has_feature(Target::AVX512_SapphireRapids)) {
+            return 32;
+        }
+        return t.bits == 64 ? 16 : 8;
+    case Target::ARM:
+        return t.bits == 64 ? 32 : 16;
+    case Target::Hexagon:
+    case Target::POWERPC:
+    case Target::RISCV:
+        return 32;
+    default:
+        return 16;
+    }
+}
+
+// Check that every access to an allocation is a dense vector of a
+// single width, or a scalar, at a constant offset aligned to that
+// width.
+class AnalyzeTileAccesses : public IRVisitor {
+    const string &name;
+    int loop_depth = 0;
+
+    using IRVisitor::visit;
+
+    void check_access(const Type &t, const Expr &index, const Expr &predicate) {
+        if (!is_const_one(predicate) || t.element_of() != type) {
+            ok = false;
+            return;
+        }
+        int access_lanes = 0;
+        const int64_t *base = nullptr;
+        if (const Ramp *r = index.as<Ramp>()) {
+            if (is_const_one(r->stride)) {
+                base = as_const_int(r->base);
+                access_lanes = r->lanes;
+            }
+        } else {
+            base = as_const_int(index);
+            access_lanes = 1;
+        }
+        if (!base || (lanes && access_lanes != lanes) || (*base % access_lanes)) {
+            ok = false;
+            return;
+        }
+        lanes = access_lanes;
+    }
+
+    void visit(const Load *op) override {
+        if (op->name == name) {
+            check_access(op->type, op->index, op->predicate);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        if (op->name == name) {
+            check_access(op->value.type(), op->index, op->predicate);
+            updated_in_loop |= loop_depth > 0;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        // The buffer is used as a whole, e.g. by an extern stage.
+        if (op->name == name) {
+            ok = false;
+        }
+    }
+
+    void visit(const For *op) override {
+        loop_depth++;
+        IRVisitor::visit(op);
+        loop_depth--;
+    }
+
+public:
+    Type type;
+    int lanes = 0;
+    bool ok = true;
+    bool updated_in_loop = false;
+
+    AnalyzeTileAccesses(const string &name, Type type)
+        : name(name), type(type) {
+    }
+};
+
+// Point the accesses to an allocation at one allocation per vector.
+class SplitTile : public IRMutator {
+    const string &name;
+    const vector<string> &vectors;
+    const int lanes;
+
+    using IRMutator::visit;
+
+    // Returns the index of the vector being accessed, and the index
+    // within it.
+    std::pair<string, Expr> split_index(const Expr &index) {
+        const Ramp *r = index.as<Ramp>();
+        const int64_t *base = as_const_int(r ? r->base : index);
+        internal_assert(base);
+        Expr new_index = make_zero(Int(32));
+        if (r) {
+            new_index = Ramp::make(new_index, 1, lanes);
+        }
+        return {vectors[*base / lanes], new_index};
+    }
+
+    Expr visit(const Load *op) override {
+        if (op->name != name) {
+            return IRMutator::visit(op);
+        }
+        auto idx = split_index(op->index);
+        return Load::make(op->type, idx.first, idx.second, op->image, op->param,
+                          op->predicate, ModulusRemainder());
+    }
+
+    Stmt visit(const Store *op) override {
+        if (op->name != name) {
+            return IRMutator::visit(op);
+        }
+        auto idx = split_index(op->index);
+        return Store::make(idx.first, mutate(op->value), idx.second, op->param,
+                           op->predicate, ModulusRemainder());
+    }
+
+    Stmt visit(const Free *op) override {
+        if (op->name != name) {
+            return op;
+        }
+        vector<Stmt> frees;
+        for (const string &v : vectors) {
+            frees.push_back(Free::make(v));
+        }
+        return Block::make(frees);
+    }
+
+public:
+    SplitTile(const string &name, const vector<string> &vectors, int lanes)
+        : name(name), vectors(vectors), lanes(lanes) {
+    }
+};
+
+class PromoteRegisterTiles : public IRMutator {
+    const int max_auto_vectors;
+    DeviceAPI device_api = DeviceAPI::Host;
+
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        DeviceAPI new_device_api =
+            op->device_api == DeviceAPI::None ? device_api : op->device_api;
+        ScopedValue<DeviceAPI> old_device_api(device_api, new_device_api);
+        return IRMutator::visit(op);
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt body = mutate(op->body);
+
+        bool candidate = (device_api == DeviceAPI::Host &&
+                          !op->new_expr.defined() &&
+                          op->free_function.empty() &&
+                          (op->memory_type == MemoryType::Auto ||
+                           op->memory_type == MemoryType::Stack ||
+                           op->memory_type == MemoryType::Register));
+        int32_t size = candidate ? op->constant_allocation_size() : 0;
+
+        AnalyzeTileAccesses analysis(op->name, op->type);
+        if (size > 0) {
+            body.accept(&analysis);
+        }
+
+        if (size <= 0 || !analysis.ok || !analysis.lanes ||
+            size % analysis.lanes != 0 ||
+            (op->memory_type != MemoryType::Register &&
+             (!analysis.updated_in_loop ||
+              size / analysis.lanes > max_auto_vectors))) {
+            if (body.same_as(op->body)) {
+                return op;
+            }
+            return Allocate::make(op->name, op->type, op->memory_type,
+                                  op->extents, op->condition, body,
+                                  op->new_expr, op->free_function);
+        }
+
+        debug(3) << "Promoting " << op->name << " to a tile of "
+                 << size / analysis.lanes << " registers of "
+                 << op->type.with_lanes(analysis.lanes) << "\n";
+
+        vector<string> vectors;
+        for (int i = 0; i < size / analysis.lanes; i++) {
+            vectors.push_back(op->name + ".reg" + std::to_string(i));
+        }
+        body = SplitTile(op->name, vectors, analysis.lanes).mutate(body);
+        for (size_t i = vectors.size(); i > 0; i--) {
+            body = Allocate::make(vectors[i - 1], op->type, MemoryType::Register,
+                                  {analysis.lanes}, op->condition, body);
+        }
+        return body;
+    }
+
+public:
+    PromoteRegisterTiles(const Target &t)
+        : max_auto_vectors(vector_register_count(t) * 3 / 4) {
+    }
+};
+
+}  // namespace
+
+Stmt promote_register_tiles(const Stmt &s, const Target &t) {
+    return PromoteRegisterTiles(t).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,36 @@
+#ifndef HALIDE_PROMOTE_REGISTER_TILES_H
+#define HALIDE_PROMOTE_REGISTER_TILES_H
+
+/** \file
+ * Defines the lowering pass that promotes small tiles of accumulators
+ * into vector registers.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+
+struct Target;
+
+namespace Internal {
+
+/** Find small constant-sized allocations on the CPU that are only
+ * ever accessed with dense vectors of a single width at constant
+ * coordinates, such as the accumulators of a reduction that has been
+ * vectorized and unrolled over a tile, and split them into one
+ * allocation per vector in MemoryType::Register. Each of those is
+ * then trivially promoted to a single vector register by codegen, so
+ * the reduction loop updates the accumulators as a block of
+ * registers, with the operands of the update broadcast against them,
+ * instead of reloading and spilling them on every iteration.
+ *
+ * Allocations explicitly placed in MemoryType::Register are always
+ * split if they qualify. Others are split only if they are updated
+ * inside a loop and fit comfortably in the vector register file of
+ * the target. Must be run after bound_small_allocations. */
+Stmt promote_register_tiles(const Stmt &s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
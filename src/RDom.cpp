@@ -193,6 +193,32 @@ RDom::RDom(const OutputImageParam &p) {
     init_vars(name);
 }
 
+namespace {
+
+// T is an ImageParam or Buffer<>
+template<typename T>
+RDom make_ragged_dom(const T &offsets, const std::string &name) {
+    user_assert(offsets.dimensions() == 1)
+        << "The offsets of a ragged RDom must be one-dimensional.\n";
+    Expr first = offsets.dim(0).min();
+    Expr rows = offsets.dim(0).extent() - 1;
+    Expr begin = offsets(first), end = offsets(first + rows);
+    RDom r(Region{{begin, end - begin}, {first, rows}}, name);
+    r.where(r.x >= offsets(r.y));
+    r.where(r.x < offsets(r.y + 1));
+    return r;
+}
+
+}  // namespace
+
+RDom RDom::ragged(const Buffer<> &offsets, const std::string &name) {
+    return make_ragged_dom(offsets, name);
+}
+
+RDom RDom::ragged(const ImageParam &offsets, const std::string &name) {
+    return make_ragged_dom(offsets, name);
+}
+
 int RDom::dimensions() const {
     return (int)dom.domain().size();
 }
@@ -19,6 +19,7 @@ namespace Halide {
 
 template<typename T>
 class Buffer;
+class ImageParam;
 class OutputImageParam;
 
 /** A reduction variable represents a single dimension of a reduction
@@ -238,6 +239,35 @@ public:
     /** Construct a reduction domain that wraps an Internal ReductionDomain object. */
     RDom(const Internal::ReductionDomain &d);
 
+    /** Construct a two-dimensional ragged reduction domain from a
+     * one-dimensional buffer of non-decreasing row offsets, as used by
+     * the CSR sparse matrix format and by batches of variable-length
+     * sequences. The outer dimension (y) iterates over the rows, and
+     * the inner dimension (x) iterates over the entries of the current
+     * row, i.e. over [offsets(y), offsets(y + 1)). For example, a
+     * sparse matrix-vector product can be written:
+     \code
+     RDom r = RDom::ragged(row_offsets);
+     y(i) = 0.0f;
+     y(r.y) += values(r.x) * x(column_indices(r.x));
+     \endcode
+     *
+     * The reduction domain is the box over all the rows, restricted
+     * using \ref RDom::where. When lowered, the loops over x are
+     * tightened to the current row instead of skipping the points
+     * outside of it, as long as all the loops over y are outside of
+     * all the loops over x. x may be split or vectorized, in which
+     * case only the last vector of each row needs to be predicated.
+     */
+    // @{
+    static RDom ragged(const Buffer<void> &offsets, const std::string &name = "");
+    static RDom ragged(const ImageParam &offsets, const std::string &name = "");
+    template<typename T>
+    HALIDE_NO_USER_CODE_INLINE static RDom ragged(const Buffer<T> &offsets, const std::string &name = "") {
+        return ragged(Buffer<void>(offsets), name);
+    }
+    // @}
+
     /** Get at the internal reduction domain object that this wraps. */
     Internal::ReductionDomain domain() const {
         return dom;
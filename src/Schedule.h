@@ -577,6 +577,14 @@ public:
     bool &async();
     bool async() const;
 
+    /** The number of footprints of an async Function's folded
+     * storage that the producer may run ahead of its consumers by. See
+     * Func::ring_buffer */
+    // @{
+    Expr &ring_buffer();
+    Expr ring_buffer() const;
+    // @}
+
     /** The list and order of dimensions used to store this
      * function. The first dimension in the vector corresponds to the
      * innermost dimension for storage (i.e. which dimension is
@@ -631,6 +639,18 @@ public:
     LoopLevel &compute_level();
     // @}
 
+    /** Where should the allocation of this function be hoisted to?
+     * The allocation is made once per iteration of this loop level,
+     * sized to fit the largest region needed by any iteration of
+     * the loops inside it, and reused by each of them. It must be
+     * outside of or equal to the store_level. If it is inlined (the
+     * default), the allocation is made at the store_level. See \ref
+     * Func::hoist_storage */
+    // @{
+    const LoopLevel &hoist_storage_level() const;
+    LoopLevel &hoist_storage_level();
+    // @}
+
     /** Pass an IRVisitor through to all Exprs referenced in the
      * Schedule. */
     void accept(IRVisitor *) const;
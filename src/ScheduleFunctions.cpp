@@ -163,6 +163,110 @@ Stmt add_predicates(const Expr &cond, bool calls, bool provides, const Stmt &s)
     return AddPredicates(cond, calls, provides).mutate(s);
 }
 
+// Return the dims of a stage that are derived from the given var by
+// splits, renames, and fuses.
+set<string> dims_derived_from(const StageSchedule &stage_s, const string &var) {
+    set<string> result{var};
+    for (const Split &split : stage_s.splits()) {
+        if (split.is_fuse()) {
+            if (result.count(split.inner) || result.count(split.outer)) {
+                result.insert(split.old_var);
+            }
+        } else if (result.count(split.old_var)) {
+            result.insert(split.outer);
+            result.insert(split.inner);
+        }
+    }
+    return result;
+}
+
+// Find the reduction variables whose range is narrowed by the
+// predicates of a stage to bounds that depend on other loop variables
+// of the stage, such as the inner dimension of a ragged RDom, and
+// return those bounds. The loops over these reduction variables are
+// tightened to the bounds inside the loops they depend on, instead of
+// iterating over the full box and skipping the points outside. This
+// requires all the loops those variables depend on to be outside of
+// all the loops over the reduction variable.
+map<string, Interval> find_ragged_rvars(const Definition &def, int start_fuse) {
+    map<string, Interval> result;
+    const StageSchedule &stage_s = def.schedule();
+    if (start_fuse >= 0 || !stage_s.fused_pairs().empty() || def.split_predicate().empty()) {
+        return result;
+    }
+
+    set<string> loop_vars;
+    for (const ReductionVariable &rv : stage_s.rvars()) {
+        loop_vars.insert(rv.var);
+    }
+    for (const Expr &arg : def.args()) {
+        if (const Variable *v = arg.as<Variable>()) {
+            loop_vars.insert(v->name);
+        }
+    }
+
+    // The position of the outermost and innermost loop derived from a var.
+    auto loop_positions = [&](const string &var) {
+        set<string> derived = dims_derived_from(stage_s, var);
+        int inner = (int)stage_s.dims().size(), outer = -1;
+        for (int i = 0; i < (int)stage_s.dims().size(); i++) {
+            if (derived.count(stage_s.dims()[i].var)) {
+                inner = std::min(inner, i);
+                outer = std::max(outer, i);
+            }
+        }
+        return std::make_pair(inner, outer);
+    };
+
+    for (const ReductionVariable &rv : stage_s.rvars()) {
+        Expr cond = const_true();
+        for (const Expr &pred : def.split_predicate()) {
+            if (expr_uses_var(pred, rv.var) && !contains_impure_call(pred)) {
+                cond = cond && pred;
+            }
+        }
+        if (is_const_one(cond)) {
+            continue;
+        }
+        Interval i = solve_for_outer_interval(simplify(cond), rv.var);
+
+        set<string> deps;
+        auto use_bound = [&](const Expr &e) {
+            if (expr_uses_var(e, rv.var)) {
+                return false;
+            }
+            bool ragged = false;
+            for (const string &v : loop_vars) {
+                if (v != rv.var && expr_uses_var(e, v)) {
+                    deps.insert(v);
+                    ragged = true;
+                }
+            }
+            return ragged;
+        };
+        Interval bounds = Interval::everything();
+        if (i.has_lower_bound() && use_bound(i.min)) {
+            bounds.min = i.min;
+        }
+        if (i.has_upper_bound() && use_bound(i.max)) {
+            bounds.max = i.max;
+        }
+        if (bounds.is_everything()) {
+            continue;
+        }
+
+        int rv_outer = loop_positions(rv.var).second;
+        bool deps_outside = true;
+        for (const string &d : deps) {
+            deps_outside = deps_outside && (loop_positions(d).first > rv_outer);
+        }
+        if (deps_outside) {
+            result.emplace(rv.var, bounds);
+        }
+    }
+    return result;
+}
+
 // Build a loop nest about a provide node using a schedule
 Stmt build_loop_nest(
     const Stmt &body,
@@ -200,6 +304,13 @@ Stmt build_loop_nest(
         dim_extent_alignment[i.var] = i.extent;
     }
 
+    // The loops over ragged reduction variables don't cover the whole
+    // reduction domain.
+    map<string, Interval> ragged_rvars = find_ragged_rvars(def, start_fuse);
+    for (const auto &rv : ragged_rvars) {
+        dim_extent_alignment.erase(rv.first);
+    }
+
     vector<Split> splits = stage_s.splits();
 
     // Find all the predicated inner variables. We can't split these.
@@ -306,6 +417,34 @@ Stmt build_loop_nest(
     }
     int n_predicates = (int)(pred_container.size());
 
+    // Define the loop bounds of ragged reduction variables, and all the
+    // loop bounds derived from them by splits, inside the loop nest, so
+    // that they can be placed inside the loops they depend on.
+    if (!ragged_rvars.empty()) {
+        for (const auto &rv : ragged_rvars) {
+            string p = prefix + rv.first;
+            Expr rmin = Variable::make(Int(32), p + ".min");
+            Expr rmax = Variable::make(Int(32), p + ".max");
+            if (rv.second.has_lower_bound()) {
+                rmin = max(rmin, qualify(prefix, rv.second.min));
+            }
+            if (rv.second.has_upper_bound()) {
+                rmax = min(rmax, qualify(prefix, rv.second.max));
+            }
+            Expr loop_min = Variable::make(Int(32), p + ".loop_min");
+            Expr loop_max = Variable::make(Int(32), p + ".loop_max");
+            nest.emplace_back(Container::Let, 0, p + ".loop_min", rmin);
+            nest.emplace_back(Container::Let, 0, p + ".loop_max", rmax);
+            nest.emplace_back(Container::Let, 0, p + ".loop_extent", loop_max - loop_min + 1);
+        }
+        for (const Split &split : splits) {
+            vector<std::pair<string, Expr>> let_stmts = compute_loop_bounds_after_split(split, prefix);
+            for (size_t i = let_stmts.size(); i > 0; i--) {
+                nest.emplace_back(Container::Let, 0, let_stmts[i - 1].first, let_stmts[i - 1].second);
+            }
+        }
+    }
+
     nest.insert(nest.end(), pred_container.begin(), pred_container.end());
 
     // Resort the containers vector so that lets are as far outwards
@@ -404,8 +543,9 @@ Stmt build_loop_nest(
 
     // Define the bounds on the split dimensions using the bounds
     // on the function args. If it is a purify, we should use the bounds
-    // from the dims instead.
-    for (size_t i = splits.size(); i > 0; i--) {
+    // from the dims instead. If there are ragged reduction variables,
+    // these have already been defined inside the loop nest.
+    for (size_t i = ragged_rvars.empty() ? splits.size() : 0; i > 0; i--) {
         const Split &split = splits[i - 1];
 
         vector<std::pair<string, Expr>> let_stmts = compute_loop_bounds_after_split(split, prefix);
@@ -437,6 +577,9 @@ Stmt build_loop_nest(
     // Define the loop mins and extents for the reduction domain (if there is any)
     // in terms of the mins and maxs produced by bounds inference
     for (const ReductionVariable &rv : stage_s.rvars()) {
+        if (ragged_rvars.count(rv.var)) {
+            continue;
+        }
         string p = prefix + rv.var;
         Expr rmin = Variable::make(Int(32), p + ".min");
         Expr rmax = Variable::make(Int(32), p + ".max");
@@ -1809,6 +1952,7 @@ public:
     struct Site {
         bool is_parallel;
         LoopLevel loop_level;
+        ForType for_type;
     };
     vector<Site> sites_allowed;
     bool found;
@@ -1845,7 +1989,7 @@ private:
         // Since we are now in the lowering phase, we expect all LoopLevels to be locked;
         // thus any new ones we synthesize we must explicitly lock.
         loop_level.lock();
-        Site s = {f->is_parallel(), loop_level};
+        Site s = {f->is_parallel(), loop_level, f->for_type};
         sites.push_back(s);
         f->body.accept(this);
         sites.pop_back();
@@ -2177,6 +2321,22 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
 
     LoopLevel store_at = f.schedule().store_level();
     LoopLevel compute_at = f.schedule().compute_level();
+    LoopLevel hoist_storage_at = f.schedule().hoist_storage_level();
+
+    if (!hoist_storage_at.is_inlined()) {
+        user_assert(!is_output)
+            << "Func " << f.name() << " is an output, so its storage can't be hoisted.\n";
+        user_assert(!compute_at.is_inlined())
+            << "Func " << f.name() << " is scheduled inline, so its storage can't be hoisted.\n";
+    }
+
+    if (f.schedule().ring_buffer().defined()) {
+        user_assert(f.schedule().async())
+            << "Func " << f.name() << " has a ring_buffer, but is not scheduled async.\n";
+        // Func::ring_buffer checks that the size is a positive constant.
+        const int64_t *n = as_const_int(f.schedule().ring_buffer());
+        internal_assert(n && *n >= 1) << f.schedule().ring_buffer() << "\n";
+    }
 
     // Outputs must be compute_root and store_root. They're really
     // store_in_user_code, but store_root is close enough.
@@ -2228,6 +2388,28 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
     std::ostringstream err;
 
     if (store_at_ok && compute_at_ok) {
+        // If there are parallel CPU loops between the store_at and the
+        // compute_at, give each parallel task its own storage by
+        // moving the store_at inwards to the innermost of them. Any
+        // serial loops remaining between the store_at and the
+        // compute_at are then slid over within each task, with the
+        // window warmed up at the start of the task. This only
+        // changes our private copy of the schedule.
+        size_t task_idx = store_idx;
+        for (size_t i = store_idx + 1; i <= compute_idx; i++) {
+            if (sites[i].for_type == ForType::Parallel) {
+                task_idx = i;
+            }
+        }
+        if (task_idx != store_idx) {
+            debug(1) << "Func " << f.name() << " is stored at " << store_at.to_string()
+                     << " outside the parallel loop over " << sites[task_idx].loop_level.to_string()
+                     << ". Storing it within each parallel task instead.\n";
+            store_idx = task_idx;
+            store_at = sites[store_idx].loop_level;
+            f.schedule().store_level() = store_at;
+        }
+
         for (size_t i = store_idx + 1; i <= compute_idx; i++) {
             if (sites[i].is_parallel) {
                 err << "Func \"" << f.name()
@@ -2253,6 +2435,29 @@ bool validate_schedule(Function f, const Stmt &s, const Target &target, bool is_
         user_error << err.str();
     }
 
+    if (!hoist_storage_at.is_inlined()) {
+        // The hoist level must be at or outside the store level, with
+        // no parallel loop in between.
+        bool hoist_storage_ok = false;
+        size_t hoist_idx = 0;
+        for (size_t i = 0; i <= store_idx; i++) {
+            if (sites[i].loop_level.match(hoist_storage_at)) {
+                hoist_storage_ok = true;
+                hoist_idx = i;
+            }
+        }
+        user_assert(hoist_storage_ok)
+            << "Func \"" << f.name() << "\" is stored at " << store_at.to_string()
+            << ", so its storage can't be hoisted to " << hoist_storage_at.to_string()
+            << ", which is not outside of it.\n";
+        for (size_t i = hoist_idx + 1; i <= store_idx; i++) {
+            user_assert(!sites[i].is_parallel)
+                << "Func \"" << f.name() << "\" has its storage hoisted outside the parallel loop over "
+                << sites[i].loop_level.to_string()
+                << ", but is stored within it. This is a potential race condition.\n";
+        }
+    }
+
     return true;
 }
 
@@ -0,0 +1,144 @@
+#include "SpecializeDenseBuffers.h"
+
+#include "IRMutator.h"
+#include "IRVisitor.h"
+#include "IROperator.h"
+#include "Parameter.h"
+#include "Substitute.h"
+#include "Target.h"
+
+#include <map>
+#include <set>
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::set;
+using std::string;
+
+namespace {
+
+// Find the external buffers accessed by a pipeline, and whether it has
+// anything to gain from knowing that they are dense and aligned.
+class FindExternalBuffers : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) override {
+        if (op->param.defined() && op->param.is_buffer()) {
+            buffers.emplace(op->name, op->param);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) override {
+        if (op->param.defined() && op->param.is_buffer()) {
+            buffers.emplace(op->name, op->param);
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *op) override {
+        has_vector_loop |= op->for_type == ForType::Vectorized;
+        has_device_loop |= (op->device_api != DeviceAPI::None &&
+                            op->device_api != DeviceAPI::Host);
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Variable *op) override {
+        symbols.insert(op->name);
+    }
+
+public:
+    map<string, Parameter> buffers;
+    set<string> symbols;
+    bool has_vector_loop = false;
+    bool has_device_loop = false;
+};
+
+// Walk past the buffer unpacking and argument checks at the top of the
+// pipeline, and multi-version what's left.
+class InjectDenseSpecialization : public IRMutator {
+    const Expr &condition;
+    const map<string, Expr> &replacements;
+
+public:
+    using IRMutator::mutate;
+
+    Stmt mutate(const Stmt &s) override {
+        if (const LetStmt *op = s.as<LetStmt>()) {
+            return LetStmt::make(op->name, op->value, mutate(op->body));
+        }
+        if (s.as<AssertStmt>()) {
+            return s;
+        }
+        const Block *block = s.as<Block>();
+        if (block && block->first.as<AssertStmt>()) {
+            return Block::make(block->first, mutate(block->rest));
+        }
+        return IfThenElse::make(condition, substitute(replacements, s), s);
+    }
+
+    InjectDenseSpecialization(const Expr &condition,
+                              const map<string, Expr> &replacements)
+        : condition(condition), replacements(replacements) {
+    }
+};
+
+}  // namespace
+
+Stmt specialize_dense_buffers(const Stmt &s, const Target &t) {
+    FindExternalBuffers finder;
+    s.accept(&finder);
+    if (!finder.has_vector_loop || finder.has_device_loop) {
+        return s;
+    }
+
+    Expr condition;
+    map<string, Expr> replacements;
+    auto add_condition = [&](const Expr &c) {
+        condition = condition.defined() ? (condition && c) : c;
+    };
+
+    for (const auto &p : finder.buffers) {
+        const string &name = p.first;
+        const Parameter &param = p.second;
+        const int lanes = t.natural_vector_size(param.type());
+        if (lanes <= 1) {
+            continue;
+        }
+
+        // In the fast path, the buffer fields the pipeline depends on
+        // are rewritten in terms of themselves to expose what the
+        // condition guarantees, so the simplifier can drop loop tails
+        // and prove vector accesses aligned.
+        auto make_multiple = [&](const string &var) {
+            if (finder.symbols.count(var)) {
+                Expr v = Variable::make(Int(32), var);
+                add_condition(v % lanes == 0);
+                replacements[var] = (v / lanes) * lanes;
+            }
+        };
+
+        const string stride_0 = name + ".stride.0";
+        if (finder.symbols.count(stride_0)) {
+            Expr v = Variable::make(Int(32), stride_0);
+            add_condition(v == 1);
+            replacements[stride_0] = 1;
+        }
+        make_multiple(name + ".min.0");
+        make_multiple(name + ".extent.0");
+        for (int d = 1; d < param.dimensions(); d++) {
+            make_multiple(name + ".stride." + std::to_string(d));
+        }
+    }
+
+    if (!condition.defined()) {
+        return s;
+    }
+
+    return InjectDenseSpecialization(condition, replacements).mutate(s);
+}
+
+}  // namespace Internal
+}  // namespace Halide
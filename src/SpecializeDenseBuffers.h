@@ -0,0 +1,31 @@
+#ifndef HALIDE_SPECIALIZE_DENSE_BUFFERS_H
+#define HALIDE_SPECIALIZE_DENSE_BUFFERS_H
+
+/** \file
+ * Defines the lowering pass that multi-versions a pipeline on whether
+ * its buffer arguments are dense and aligned.
+ */
+
+#include "Expr.h"
+
+namespace Halide {
+
+struct Target;
+
+namespace Internal {
+
+/** Split the body of a pipeline with vectorized loops into a fast path
+ * for the case where all of its external buffers are dense and aligned
+ * to the natural vector width of the target (innermost stride one,
+ * innermost min and extent and outer strides multiples of the vector
+ * width), and a generic fallback. Host pointers are still only assumed
+ * to be as aligned as their Parameters declare. The dispatch is done
+ * once at pipeline entry, so the inner loops of neither path carry any
+ * checks. Must be run after unpack_buffers. Enabled by
+ * Target::SpecializeDenseBuffers. */
+Stmt specialize_dense_buffers(const Stmt &s, const Target &t);
+
+}  // namespace Internal
+}  // namespace Halide
+
+#endif
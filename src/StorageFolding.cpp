@@ -763,6 +763,18 @@ class AttemptStorageFoldingOfFunction : public IRMutator {
                 }
             }
 
+            Expr ring_buffer = func.schedule().ring_buffer();
+            if (func.schedule().async() && ring_buffer.defined() && dynamic_footprint.empty()) {
+                // Make room in the circular buffer for the producer
+                // to run several footprints ahead of the consumer. The
+                // semaphore below is initialized to the factor, so
+                // its count grows to match. (If the footprint is
+                // tracked dynamically, the checks injected above are
+                // in terms of the unscaled fold factor, so leave it
+                // alone.)
+                factor = simplify(factor * ring_buffer);
+            }
+
             debug(3) << "Proceeding with factor " << factor << "\n";
 
             Fold fold = {(int)i - 1, factor};
@@ -953,6 +965,16 @@ class StorageFolding : public IRMutator {
         }
         body = folder.mutate(body);
 
+        bool ring_buffered = false;
+        for (const auto &fold : folder.dims_folded) {
+            ring_buffered |= fold.semaphore.var.defined() && fold.head.empty();
+        }
+        if (func_it != env.end() && func.schedule().ring_buffer().defined() && !ring_buffered) {
+            user_warning << "Func " << op->name << " has a ring_buffer, but its storage "
+                         << "could not be folded with a statically-sized circular buffer, "
+                         << "so the ring_buffer has no effect.\n";
+        }
+
         if (body.same_as(op->body)) {
             return op;
         } else if (folder.dims_folded.empty()) {
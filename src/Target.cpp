@@ -161,6 +161,13 @@ Target calculate_host_target() {
         const uint32_t avx512_cannonlake = avx512_skylake | avx512ifma;  // Assume ifma => vbmi
         if ((info2[1] & avx2) == avx2) {
             initial_features.push_back(Target::AVX2);
+
+            const uint32_t avxvnni = 1U << 4;  // avxvnni result in eax, with cpuid(eax=7, ecx=1)
+            int info3[4];
+            cpuid(info3, 7, 1);
+            if ((info3[0] & avxvnni) == avxvnni) {
+                initial_features.push_back(Target::AVXVNNI);
+            }
         }
         if ((info2[1] & avx512) == avx512) {
             initial_features.push_back(Target::AVX512);
@@ -384,6 +391,10 @@ const std::map<std::string, Target::Feature> feature_name_map = {
     {"llvm_large_code_model", Target::LLVMLargeCodeModel},
     {"rvv", Target::RVV},
     {"armv81a", Target::ARMv81a},
+    {"auto_prefetch", Target::AutoPrefetch},
+    {"specialize_dense_buffers", Target::SpecializeDenseBuffers},
+    {"avxvnni", Target::AVXVNNI},
+    {"multiversion", Target::Multiversion},
     // NOTE: When adding features to this map, be sure to update PyEnums.cpp as well.
 };
 
@@ -485,6 +496,17 @@ bool merge_string(Target &t, const std::string &target) {
         } else if (tok == "trace_all") {
             t.set_features({Target::TraceLoads, Target::TraceStores, Target::TraceRealizations});
             features_specified = true;
+        } else if (Internal::starts_with(tok, "vector_bits_")) {
+            const string bits_str = tok.substr(sizeof("vector_bits_") - 1);
+            if (bits_str.empty() || bits_str.find_first_not_of("0123456789") != string::npos ||
+                bits_str.size() > 4) {
+                return false;
+            }
+            t.vector_bits = std::stoi(bits_str);
+            if (t.vector_bits <= 0 || t.vector_bits % 128 != 0 || t.vector_bits > 2048) {
+                return false;
+            }
+            features_specified = true;
         } else {
             return false;
         }
@@ -559,6 +581,9 @@ void bad_target_string(const std::string &target) {
                << "\n"
                << "Features are: " << features << ".\n"
                << "\n"
+               << "For targets with scalable vectors (SVE, SVE2, RVV), the vector register\n"
+               << "width can be given in bits as vector_bits_N, e.g. vector_bits_256.\n"
+               << "\n"
                << "The target can also begin with \"host\", which sets the "
                << "host's architecture, os, and feature set, with the "
                << "exception of the GPU runtimes, which default to off.\n"
@@ -633,6 +658,9 @@ std::string Target::to_string() const {
     if (has_feature(Target::TraceLoads) && has_feature(Target::TraceStores) && has_feature(Target::TraceRealizations)) {
         result = Internal::replace_all(result, "trace_loads-trace_realizations-trace_stores", "trace_all");
     }
+    if (vector_bits != 0) {
+        result += "-vector_bits_" + std::to_string(vector_bits);
+    }
     return result;
 }
 
@@ -927,6 +955,23 @@ int Target::natural_vector_size(const Halide::Type &t) const {
             // SSE was all 128-bit. We ignore MMX.
             return 16 / data_size;
         }
+    } else if (arch == Target::ARM) {
+        if (vector_bits != 0 &&
+            (has_feature(Halide::Target::SVE) || has_feature(Halide::Target::SVE2))) {
+            // Vectors as wide as the SVE registers we were promised.
+            return vector_bits / (data_size * 8);
+        } else {
+            // NEON is 128-bit.
+            return 16 / data_size;
+        }
+    } else if (arch == Target::RISCV) {
+        if (vector_bits != 0 && has_feature(Halide::Target::RVV)) {
+            // Vectors as wide as the RVV registers we were promised.
+            return vector_bits / (data_size * 8);
+        } else {
+            // The V extension requires at least 128-bit registers.
+            return 16 / data_size;
+        }
     } else if (arch == Target::WebAssembly) {
         if (has_feature(Halide::Target::WasmSimd128)) {
             // 128-bit vectors for other types.
@@ -975,7 +1020,7 @@ bool Target::get_runtime_compatible_target(const Target &other, Target &result)
     // clang-format on
 
     // clang-format off
-    const std::array<Feature, 14> intersection_features = {{
+    const std::array<Feature, 15> intersection_features = {{
         ARMv7s,
         ARMv81a,
         AVX,
@@ -985,6 +1030,7 @@ bool Target::get_runtime_compatible_target(const Target &other, Target &result)
         AVX512_KNL,
         AVX512_SapphireRapids,
         AVX512_Skylake,
+        AVXVNNI,
         F16C,
         FMA,
         FMA4,
@@ -50,6 +50,14 @@ struct Target {
     /** The bit-width of the target machine. Must be 0 for unknown, or 32 or 64. */
     int bits = 0;
 
+    /** The bit-width of a vector register for targets where this is
+     * configurable, such as ARM with SVE or SVE2 and RISC-V with RVV, and
+     * code for a fixed vector size is desired. Must be 0 if unknown, which makes no
+     * assumption beyond the minimum vector size of the architecture, or
+     * a multiple of 128 up to 2048. Corresponds to the vector_bits_N
+     * token in target strings. */
+    int vector_bits = 0;
+
     /** Optional features a target can have.
      * Corresponds to feature_name_map in Target.cpp.
      * See definitions in HalideRuntime.h for full information.
@@ -131,6 +139,10 @@ struct Target {
         LLVMLargeCodeModel = halide_llvm_large_code_model,
         RVV = halide_target_feature_rvv,
         ARMv81a = halide_target_feature_armv81a,
+        AutoPrefetch = halide_target_feature_auto_prefetch,
+        SpecializeDenseBuffers = halide_target_feature_specialize_dense_buffers,
+        AVXVNNI = halide_target_feature_avxvnni,
+        Multiversion = halide_target_feature_multiversion,
         FeatureEnd = halide_target_feature_end
     };
     Target() = default;
@@ -224,6 +236,7 @@ struct Target {
         return os == other.os &&
                arch == other.arch &&
                bits == other.bits &&
+               vector_bits == other.vector_bits &&
                features == other.features;
     }
 
@@ -41,6 +41,16 @@
     *** DEPRECATED *** use the 'schedule' output from Generator instead
     Write out a human-and-machine readable block of scheduling source code for the selected schedule into this file.
 
+  HL_SCHEDULE_SEED
+  Warm-start the search from a previous result. Set to a file containing schedule source emitted by the
+  autoscheduler (either the 'schedule' output from Generator or the file written by HL_SCHEDULE_FILE).
+  The search is restricted to schedules that place each Func (inlined, compute_root, or computed at a
+  particular consumer) as in that schedule, and re-tunes the tilings and parallelism. Funcs that aren't
+  mentioned in the seed are searched as usual. Defaults to a single pass of beam search.
+
+  HL_SCHEDULE_SEED_RADIUS
+  The number of Funcs that may be placed differently to the HL_SCHEDULE_SEED schedule. Defaults to 0.
+
   HL_RANDOM_DROPOUT
   percent chance of accepting each state in the beam. Normalized by the number of decisions made, so 5 would be there's a 5 percent chance of never rejecting any states.
 
@@ -50,6 +60,10 @@
   HL_WEIGHTS_DIR
   When training or schedule, read weights from this directory or file
   (if path ends in `.weights` it is written as a single file, otherwise a directory of files)
+  When scheduling for a GPU target and this is not set, the analytical cost model in
+  GPUSimulation.h is used instead of the learned one, so no GPU is needed at search time.
+  To train weights for GPU targets offline, label featurizations with simulated runtimes
+  using `featurization_to_sample in.featurization simulate ...`.
 
   HL_NO_SUBTILING
   If set to 1, limits the search space to that of Mullapudi et al.
@@ -59,7 +73,13 @@
   value of HL_DEBUG_CODEGEN, if any).
 
   HL_AUTOSCHEDULE_MEMORY_LIMIT
-  If set, only consider schedules that allocate at most this much memory (measured in bytes).
+  If set, only consider schedules whose predicted peak memory allocation is at most this much (measured in bytes).
+  The peak is estimated from the allocation lifetimes implied by the loop nest, counting one copy of each
+  allocation per concurrently-running parallel task.
+
+  HL_AUTOSCHEDULE_MEMORY_BUDGET
+  If set, a soft version of HL_AUTOSCHEDULE_MEMORY_LIMIT (measured in bytes). Schedules whose predicted peak
+  memory exceeds the budget are not rejected, but have their cost scaled up by the ratio of the peak to the budget.
 
   HL_DISABLE_MEMOIZED_FEATURES
   If set, features of possible schedules are always recalculated, and are not cached across passes.
@@ -97,6 +117,8 @@
 #include "LoopNest.h"
 #include "NetworkSize.h"
 #include "PerfectHashMap.h"
+#include "ScheduleSeed.h"
+#include "SimulatedGPUCostModel.h"
 #include "State.h"
 #include "Timer.h"
 
@@ -267,11 +289,13 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
                                           std::mt19937 &rng,
                                           int beam_size,
                                           int64_t memory_limit,
+                                          int64_t memory_budget,
                                           int pass_idx,
                                           int num_passes,
                                           ProgressBar &tick,
                                           std::unordered_set<uint64_t> &permitted_hashes,
-                                          Cache *cache) {
+                                          Cache *cache,
+                                          const ScheduleSeed *seed) {
 
     if (cost_model) {
         configure_pipeline_features(dag, params, cost_model);
@@ -327,11 +351,13 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
                                              rng,
                                              beam_size * 2,
                                              memory_limit,
+                                             memory_budget,
                                              pass_idx,
                                              num_passes,
                                              tick,
                                              permitted_hashes,
-                                             cache);
+                                             cache,
+                                             seed);
             } else {
                 internal_error << "Ran out of legal states with beam size " << beam_size << "\n";
             }
@@ -419,7 +445,7 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
                 return best;
             }
 
-            state->generate_children(dag, params, cost_model, memory_limit, enqueue_new_children, cache);
+            state->generate_children(dag, params, cost_model, memory_limit, enqueue_new_children, cache, seed);
             expanded++;
         }
 
@@ -429,6 +455,9 @@ IntrusivePtr<State> optimal_schedule_pass(FunctionDAG &dag,
         if (cost_model) {
             // Now evaluate all the costs and re-sort them in the priority queue
             cost_model->evaluate_costs();
+            for (size_t j = 0; j < q.size(); j++) {
+                q[j]->apply_memory_budget(memory_budget);
+            }
             q.resort();
         }
 
@@ -469,7 +498,8 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
                                      std::mt19937 &rng,
                                      int beam_size,
                                      int64_t memory_limit,
-                                     const CachingOptions &options) {
+                                     const CachingOptions &options,
+                                     const ScheduleSeed *seed) {
 
     IntrusivePtr<State> best;
 
@@ -481,6 +511,12 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
     // If the beam size is one, it's pointless doing multiple passes.
     int num_passes = (beam_size == 1) ? 1 : 5;
 
+    if (seed) {
+        // The seed already narrows the search down to a small
+        // neighborhood, so coarse-to-fine passes buy little.
+        num_passes = 1;
+    }
+
     string cyos_str = get_env_variable("HL_CYOS");
     if (cyos_str == "1") {
         // If the user is manually navigating the search space, don't
@@ -494,14 +530,17 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
         num_passes = std::atoi(num_passes_str.c_str());
     }
 
+    string memory_budget_str = get_env_variable("HL_AUTOSCHEDULE_MEMORY_BUDGET");
+    int64_t memory_budget = memory_budget_str.empty() ? -1 : std::atoll(memory_budget_str.c_str());
+
     for (int i = 0; i < num_passes; i++) {
         ProgressBar tick;
 
         Timer timer;
 
         auto pass = optimal_schedule_pass(dag, outputs, params, cost_model,
-                                          rng, beam_size, memory_limit,
-                                          i, num_passes, tick, permitted_hashes, &cache);
+                                          rng, beam_size, memory_limit, memory_budget,
+                                          i, num_passes, tick, permitted_hashes, &cache, seed);
 
         std::chrono::duration<double> total_time = timer.elapsed();
         auto milli = std::chrono::duration_cast<std::chrono::milliseconds>(total_time).count();
@@ -509,7 +548,8 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
         tick.clear();
 
         if (aslog::aslog_level() == 0) {
-            aslog(0) << "Pass " << i << " of " << num_passes << ", cost: " << pass->cost << ", time (ms): " << milli << "\n";
+            aslog(0) << "Pass " << i << " of " << num_passes << ", cost: " << pass->cost
+                     << ", predicted peak memory: " << pass->peak_memory << " bytes, time (ms): " << milli << "\n";
         } else {
             aslog(0) << "Pass " << i << " result: ";
             pass->dump();
@@ -522,7 +562,7 @@ IntrusivePtr<State> optimal_schedule(FunctionDAG &dag,
         }
     }
 
-    aslog(0) << "Best cost: " << best->cost << "\n";
+    aslog(0) << "Best cost: " << best->cost << ", predicted peak memory: " << best->peak_memory << " bytes\n";
 
     if (options.cache_blocks) {
         aslog(0) << "Cache (block) hits: " << cache.cache_hits << "\n";
@@ -574,16 +614,32 @@ void generate_schedule(const std::vector<Function> &outputs,
     string memory_limit_str = get_env_variable("HL_AUTOSCHEDULE_MEMORY_LIMIT");
     int64_t memory_limit = memory_limit_str.empty() ? (uint64_t)(-1) : std::atoll(memory_limit_str.c_str());
 
+    std::unique_ptr<ScheduleSeed> schedule_seed;
+    string seed_path = get_env_variable("HL_SCHEDULE_SEED");
+    if (!seed_path.empty()) {
+        string seed_radius_str = get_env_variable("HL_SCHEDULE_SEED_RADIUS");
+        int seed_radius = seed_radius_str.empty() ? 0 : std::atoi(seed_radius_str.c_str());
+        schedule_seed = load_schedule_seed(seed_path, seed_radius);
+        aslog(1) << "Seeding the search with " << schedule_seed->decisions.size() << " Func placements from " << seed_path << "\n";
+    }
+
     // Analyse the Halide algorithm and construct our abstract representation of it
     FunctionDAG dag(outputs, params, target);
     if (aslog::aslog_level() > 0) {
         dag.dump();
     }
 
-    // Construct a cost model to use to evaluate states. Currently we
-    // just have the one, but it's an abstract interface, so others
-    // can be slotted in for experimentation.
-    std::unique_ptr<CostModel> cost_model = make_default_cost_model(weights_in_path, weights_out_path, randomize_weights);
+    // Construct a cost model to use to evaluate states. The learned
+    // model is trained on CPU schedules, so for GPU targets we use an
+    // analytical model instead, unless weights are explicitly
+    // provided (e.g. trained on simulated GPU runtimes).
+    std::unique_ptr<CostModel> cost_model;
+    if (target.has_gpu_feature() && weights_in_path.empty()) {
+        aslog(1) << "Using the simulated GPU cost model\n";
+        cost_model = make_simulated_gpu_cost_model();
+    } else {
+        cost_model = make_default_cost_model(weights_in_path, weights_out_path, randomize_weights);
+    }
     internal_assert(cost_model != nullptr);
 
     IntrusivePtr<State> optimal;
@@ -592,7 +648,7 @@ void generate_schedule(const std::vector<Function> &outputs,
     CachingOptions cache_options = CachingOptions::MakeOptionsFromEnviron();
 
     // Run beam search
-    optimal = optimal_schedule(dag, outputs, params, cost_model.get(), rng, beam_size, memory_limit, cache_options);
+    optimal = optimal_schedule(dag, outputs, params, cost_model.get(), rng, beam_size, memory_limit, cache_options, schedule_seed.get());
 
     HALIDE_TOC;
 
@@ -670,7 +726,7 @@ void find_and_apply_schedule(FunctionDAG &dag,
 
     std::mt19937 rng(12345);
     CachingOptions cache_options = CachingOptions::MakeOptionsFromEnviron();
-    IntrusivePtr<State> optimal = optimal_schedule(dag, outputs, params, cost_model, rng, beam_size, memory_limit, cache_options);
+    IntrusivePtr<State> optimal = optimal_schedule(dag, outputs, params, cost_model, rng, beam_size, memory_limit, cache_options, nullptr);
 
     // Apply the schedules
     optimal->apply_schedule(dag, params);
@@ -570,7 +570,8 @@ bool depends_on_estimate(const Expr &expr) {
     return dependency_checker.found_estimate;
 }
 
-FunctionDAG::FunctionDAG(const vector<Function> &outputs, const MachineParams &params, const Target &target) {
+FunctionDAG::FunctionDAG(const vector<Function> &outputs, const MachineParams &params, const Target &target)
+    : target(target) {
     map<string, Function> env = build_environment(outputs);
 
     // A mutator to apply parameter estimates to the expressions
@@ -850,7 +851,13 @@ FunctionDAG::FunctionDAG(const vector<Function> &outputs, const MachineParams &p
                 node.bytes_per_point = bytes_per_point;
             }
 
-            stage.vector_size = target.natural_vector_size(checker.narrowest_type);
+            if (target.has_gpu_feature()) {
+                // The innermost loop is mapped to gpu_threads, so
+                // make it a warp wide.
+                stage.vector_size = 32;
+            } else {
+                stage.vector_size = target.natural_vector_size(checker.narrowest_type);
+            }
 
             if (s == 0) {
                 node.vector_size = stage.vector_size;
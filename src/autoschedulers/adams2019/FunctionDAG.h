@@ -561,6 +561,9 @@ struct FunctionDAG {
     vector<Node> nodes;
     vector<Edge> edges;
 
+    // The target the pipeline is being scheduled for.
+    Target target;
+
     // Create the function DAG, and do all the dependency and cost
     // analysis. This is done once up-front before the tree search.
     FunctionDAG(const vector<Function> &outputs, const MachineParams &params, const Target &target);
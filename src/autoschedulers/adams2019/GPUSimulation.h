@@ -0,0 +1,124 @@
+#ifndef GPU_SIMULATION_H
+#define GPU_SIMULATION_H
+
+// An analytical model of the runtime of a pipeline stage on a GPU,
+// computed purely from its featurization. It is used to rank GPU
+// schedules without access to a GPU, and to label featurizations
+// with simulated runtimes so that the learned cost model can be
+// trained offline on CPU-only machines.
+//
+// This file is used by featurization_to_sample, which doesn't link
+// to libHalide, so it must only depend on Featurization.h.
+
+#include <algorithm>
+#include <cmath>
+
+#include "Featurization.h"
+
+namespace Halide {
+namespace Internal {
+namespace Autoscheduler {
+
+// A description of the simulated GPU. The defaults are loosely
+// modeled on a mid-range discrete GPU.
+struct GPUSimulationParams {
+    // Number of streaming multiprocessors (compute units).
+    double num_sms = 40;
+    // Number of arithmetic lanes per SM that can issue each cycle.
+    double lanes_per_sm = 64;
+    // Shader clock rate, in Hz.
+    double clock_rate = 1.5e9;
+    // Global memory bandwidth, in bytes per second.
+    double memory_bandwidth = 400e9;
+    // Size of one global memory transaction, in bytes.
+    double transaction_bytes = 128;
+    // Shared memory available to one block, in bytes.
+    double shared_memory_per_block = 48 * 1024;
+    // Fixed cost of launching a kernel, in seconds.
+    double kernel_launch_overhead = 5e-6;
+    // Number of threads in a warp.
+    double warp_size = 32;
+};
+
+// Estimate the runtime (in seconds) of one stage, given its
+// algorithm-specific and schedule-specific features. In the
+// GPU mapping used by LoopNest::apply, compute_root stages are
+// kernels whose parallel loops are gpu_blocks, the innermost
+// (vectorized) loop of each stage inside a block is gpu_threads, and
+// allocations inside a block are staged in shared memory.
+inline double simulate_stage_runtime(const PipelineFeatures &pipeline_feat,
+                                     const ScheduleFeatures &sched_feat,
+                                     const GPUSimulationParams &params) {
+    using OpType = PipelineFeatures::OpType;
+    using ScalarType = PipelineFeatures::ScalarType;
+
+    // Arithmetic work per point computed. Leaves of the expression
+    // tree are free.
+    double ops_per_point = 0;
+    for (int o = 0; o < (int)OpType::NumOpTypes; o++) {
+        if (o == (int)OpType::Const ||
+            o == (int)OpType::Variable ||
+            o == (int)OpType::Param) {
+            continue;
+        }
+        for (int t = 0; t < (int)ScalarType::NumScalarTypes; t++) {
+            ops_per_point += pipeline_feat.op_histogram[o][t];
+        }
+    }
+    ops_per_point = std::max(1.0, ops_per_point);
+
+    // Each lane of the innermost loop is a thread. Partial warps
+    // cost as much as full ones, and scalar tails run one active
+    // thread per warp.
+    const double warps_per_vector = std::ceil(std::max(1.0, sched_feat.vector_size) / params.warp_size);
+    const double thread_slots = (sched_feat.num_vectors * warps_per_vector + sched_feat.num_scalars) * params.warp_size;
+    const double compute_time = (thread_slots * ops_per_point) /
+                                (params.num_sms * params.lanes_per_sm * params.clock_rate);
+
+    // Blocks that can run concurrently. Fewer blocks than SMs leaves
+    // the GPU partially idle.
+    const double blocks = std::max(1.0, std::max(sched_feat.inner_parallelism, sched_feat.outer_parallelism));
+    const double utilization = std::min(1.0, blocks / params.num_sms);
+
+    // compute_root stages are their own kernel, and always
+    // write their output to global memory. Other stages write to
+    // shared memory if it's large enough to hold the working set of
+    // the block.
+    const bool is_kernel = sched_feat.num_productions <= 1;
+    const bool spills_to_global = !is_kernel && sched_feat.working_set_at_task > params.shared_memory_per_block;
+
+    // Loads from outside the block come from global memory. Short
+    // contiguous runs waste the remainder of each transaction.
+    const double tasks = std::max(1.0, sched_feat.inner_parallelism);
+    const double bytes_loaded = sched_feat.unique_bytes_read_per_task * tasks;
+    const double lines_loaded = sched_feat.unique_lines_read_per_task * tasks;
+    double transactions = std::max(bytes_loaded / params.transaction_bytes, lines_loaded);
+
+    double bytes_stored = 0;
+    if (is_kernel) {
+        bytes_stored = sched_feat.bytes_at_root;
+    } else if (spills_to_global) {
+        // Written once and read back at least once.
+        bytes_stored = 2 * sched_feat.bytes_at_production * sched_feat.num_productions;
+    }
+    if (bytes_stored > 0) {
+        // Stores are coalesced if the innermost dimension of the
+        // region written per block spans whole transactions.
+        const double innermost = std::max(1.0, sched_feat.innermost_bytes_at_task);
+        const double efficiency = std::min(1.0, innermost / params.transaction_bytes);
+        transactions += bytes_stored / (params.transaction_bytes * efficiency);
+    }
+    const double memory_time = (transactions * params.transaction_bytes) / params.memory_bandwidth;
+
+    double runtime = std::max(compute_time, memory_time) / utilization;
+    if (is_kernel) {
+        runtime += params.kernel_launch_overhead;
+    }
+    return runtime;
+}
+
+}  // namespace Autoscheduler
+}  // namespace Internal
+}  // namespace Halide
+
+#endif  // GPU_SIMULATION_H
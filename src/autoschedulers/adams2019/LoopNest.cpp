@@ -1179,6 +1179,74 @@ int64_t LoopNest::max_inlined_calls() const {
     return result;
 }
 
+// Estimate the peak number of bytes simultaneously allocated within
+// this loop nest, using the lifetimes implied by the order of the
+// children.
+int64_t LoopNest::peak_memory(const MachineParams &params) const {
+    // The children are stored in the reverse of the order in which
+    // they run, so the last child is the first to execute.
+    const int num_children = (int)children.size();
+
+    struct Allocation {
+        int64_t bytes;
+        int first, last;
+    };
+    std::vector<Allocation> allocations;
+    int64_t always_live = 0;
+    for (const auto *f : store_at) {
+        if (f->is_output) {
+            // Allocated by the caller
+            continue;
+        }
+        const auto &b = get_bounds(f);
+        int64_t bytes = f->bytes_per_point;
+        for (int i = 0; i < f->dimensions; i++) {
+            bytes *= b->region_computed(i).extent();
+        }
+        Allocation a{bytes, num_children, -1};
+        for (int i = 0; i < num_children; i++) {
+            const int t = num_children - 1 - i;
+            if (children[i]->computes(f)) {
+                a.first = std::min(a.first, t);
+            }
+            if (children[i]->calls(f)) {
+                a.last = std::max(a.last, t);
+            }
+        }
+        if (a.first > a.last) {
+            // We couldn't place the lifetime within the children, so
+            // conservatively assume it's live throughout.
+            always_live += bytes;
+        } else {
+            allocations.push_back(a);
+        }
+    }
+
+    int64_t peak = always_live;
+    for (int i = 0; i < num_children; i++) {
+        const int t = num_children - 1 - i;
+        int64_t live = always_live;
+        for (const auto &a : allocations) {
+            if (a.first <= t && t <= a.last) {
+                live += a.bytes;
+            }
+        }
+        peak = std::max(peak, live + children[i]->peak_memory(params));
+    }
+
+    if (parallel) {
+        // Each concurrently-running task gets its own copy of the
+        // allocations in the loop body.
+        int64_t tasks = 1;
+        for (auto s : size) {
+            tasks *= s;
+        }
+        peak *= std::max((int64_t)1, std::min(tasks, (int64_t)params.parallelism));
+    }
+
+    return peak;
+}
+
 // Does this loop nest access an input buffer? Used to select
 // trail strategies when splitting loops. We don't want to read
 // out of bounds on inputs, even if we don't intend to use the
@@ -1676,11 +1744,13 @@ void LoopNest::apply(LoopLevel here,
                      double num_cores,
                      int depth,
                      const LoopNest *parent,
-                     const LoopNest *compute_site) const {
+                     const LoopNest *compute_site,
+                     const Target &target,
+                     bool in_gpu_blocks) const {
     if (is_root()) {
         for (const auto &c : children) {
             Func(c->node->func).compute_root();
-            c->apply(LoopLevel::root(), state_map, num_cores, 1, this, c.get());
+            c->apply(LoopLevel::root(), state_map, num_cores, 1, this, c.get(), target, false);
             if (c->stage->index == 0) {
                 auto &state = state_map.get(c->stage);
                 state->schedule_source << "\n    .compute_root()";
@@ -1741,7 +1811,14 @@ void LoopNest::apply(LoopLevel here,
                 const auto &p = parent_bounds->region_computed(i);
                 bytes *= p.extent();
             }
-            if (bytes < 64000 && depth > 2) {
+            if (in_gpu_blocks && target.has_gpu_feature()) {
+                // Stage it in shared memory if it fits. Otherwise let
+                // it go to global memory.
+                if (bytes <= 48 * 1024) {
+                    Func(node->func).store_in(MemoryType::GPUShared);
+                    state.schedule_source << "\n    .store_in(MemoryType::GPUShared)";
+                }
+            } else if (bytes < 64000 && depth > 2) {
                 // If it's probably a small allocation, and it's
                 // made more than once, use stack-scoped
                 // storage. Otherwise let the compiler pick heap
@@ -1780,9 +1857,15 @@ void LoopNest::apply(LoopLevel here,
                     auto &v = state.vars[i];
                     internal_assert(v.innermost_pure_dim && v.exists) << v.var.name() << "\n";
                     // Is the result of a split
-                    state.schedule_source
-                        << "\n    .vectorize(" << v.var.name() << ")";
-                    s.vectorize(v.var);
+                    if (in_gpu_blocks && target.has_gpu_feature()) {
+                        state.schedule_source
+                            << "\n    .gpu_threads(" << v.var.name() << ")";
+                        s.gpu_threads(v.var);
+                    } else {
+                        state.schedule_source
+                            << "\n    .vectorize(" << v.var.name() << ")";
+                        s.vectorize(v.var);
+                    }
                 }
             } else {
                 // Grab the innermost loop for this node
@@ -1922,9 +2005,14 @@ void LoopNest::apply(LoopLevel here,
         for (const auto *f : store_at) {
             Func(f->func).store_at(here);
         }
+        // Parallel loops with more than one iteration become gpu_blocks
+        // on GPU targets. See State::apply_schedule.
+        int64_t total_size = 1;
         for (auto s : size) {
             num_cores /= s;
+            total_size *= s;
         }
+        const bool this_loop_is_gpu_blocks = parallel && total_size > 1 && target.has_gpu_feature();
         here.lock();
         string loop_level;
         if (here.is_root()) {
@@ -1936,7 +2024,8 @@ void LoopNest::apply(LoopLevel here,
             if (c->node != node) {
                 Func(c->node->func).compute_at(here);
             }
-            c->apply(here, state_map, num_cores, depth + 1, this, compute_site);
+            c->apply(here, state_map, num_cores, depth + 1, this, compute_site,
+                     target, in_gpu_blocks || this_loop_is_gpu_blocks);
             if (c->node != node && c->stage->index == 0) {
                 auto &state = *(state_map.get(c->stage));
                 state.schedule_source << "\n    .compute" << loop_level;
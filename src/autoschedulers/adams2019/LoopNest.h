@@ -167,6 +167,14 @@ struct LoopNest {
     // generate too much code.
     int64_t max_inlined_calls() const;
 
+    // Estimate the peak number of bytes simultaneously allocated
+    // within this loop nest. Each Func stored here is considered live
+    // from the first child that computes it to the last child that
+    // calls it, and allocations inside a parallel loop are replicated
+    // once per concurrently-running task. Inputs and outputs are not
+    // allocated by the pipeline, so they are not counted.
+    int64_t peak_memory(const MachineParams &params) const;
+
     // Does this loop nest access an input buffer? Used to select
     // trail strategies when splitting loops. We don't want to read
     // out of bounds on inputs, even if we don't intend to use the
@@ -254,13 +262,20 @@ struct LoopNest {
         std::ostringstream schedule_source;
     };
 
-    // Apply the schedule represented by this loop nest to a Halide pipeline.
+    // Apply the schedule represented by this loop nest to a Halide
+    // pipeline. On GPU targets, parallel loops become gpu_blocks (see
+    // State::apply_schedule), and within them the innermost loop of
+    // each stage becomes gpu_threads and small allocations are placed
+    // in shared memory. 'in_gpu_blocks' says whether this loop is
+    // inside a gpu_blocks loop.
     void apply(LoopLevel here,
                StageMap<std::unique_ptr<StageScheduleState>> &state_map,
                double num_cores,
                int depth,
                const LoopNest *parent,
-               const LoopNest *compute_site) const;
+               const LoopNest *compute_site,
+               const Target &target,
+               bool in_gpu_blocks) const;
 
     // The below are two feature caches.
     // hash of producers -> StageMap
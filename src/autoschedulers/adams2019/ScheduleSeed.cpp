@@ -0,0 +1,163 @@
+#include "ScheduleSeed.h"
+
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "Errors.h"
+
+namespace Halide {
+namespace Internal {
+namespace Autoscheduler {
+
+using std::string;
+
+namespace {
+
+bool is_identifier_char(char c) {
+    return std::isalnum((unsigned char)c) || c == '_';
+}
+
+size_t skip_whitespace(const string &s, size_t i) {
+    while (i < s.size() && std::isspace((unsigned char)s[i])) {
+        i++;
+    }
+    return i;
+}
+
+// Read the identifier starting at position i, and advance i past it.
+string read_identifier(const string &s, size_t &i) {
+    size_t start = i;
+    while (i < s.size() && is_identifier_char(s[i])) {
+        i++;
+    }
+    return s.substr(start, i - start);
+}
+
+// The emitted schedule source replaces '$' in names to make them
+// legal identifiers. Do the same to names in the DAG to match them up.
+string sanitize(const string &name) {
+    string result = name;
+    for (auto &c : result) {
+        if (c == '$') {
+            c = '_';
+        }
+    }
+    return result;
+}
+
+// Find the loop that a Func is computed directly inside of. Returns
+// nullptr if it is inlined.
+const LoopNest *find_compute_site(const LoopNest *loop, const FunctionDAG::Node *node) {
+    for (const auto &c : loop->children) {
+        if (c->node == node && loop->node != node) {
+            return loop;
+        }
+        const LoopNest *site = find_compute_site(c.get(), node);
+        if (site) {
+            return site;
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+bool ScheduleSeed::parse(const string &source) {
+    // Drop comments and preprocessor directives, so that what remains
+    // is a sequence of statements.
+    std::ostringstream code;
+    {
+        std::istringstream lines(source);
+        string line;
+        while (std::getline(lines, line)) {
+            size_t i = skip_whitespace(line, 0);
+            if (line.compare(i, 2, "//") == 0 || line.compare(i, 1, "#") == 0) {
+                continue;
+            }
+            code << line << "\n";
+        }
+    }
+
+    std::set<string> declared;
+    std::istringstream statements(code.str());
+    string stmt;
+    while (std::getline(statements, stmt, ';')) {
+        size_t i = skip_whitespace(stmt, 0);
+        string name = read_identifier(stmt, i);
+        if (name.empty()) {
+            continue;
+        }
+
+        if (name == "Func") {
+            // A Func handle, e.g. "Func f = pipeline.get_func(3)". Funcs
+            // with a handle but no schedule of their own were inlined.
+            i = skip_whitespace(stmt, i);
+            string func = read_identifier(stmt, i);
+            if (!func.empty()) {
+                declared.insert(func);
+            }
+            continue;
+        }
+
+        // The schedule of a pure stage is the Func name followed by a
+        // chain of directives. Update stages don't carry compute_at
+        // information, so skip them.
+        i = skip_whitespace(stmt, i);
+        if (i >= stmt.size() || stmt[i] != '.' || stmt.compare(i, 8, ".update(") == 0) {
+            continue;
+        }
+
+        Decision d;
+        const string compute_at = ".compute_at(";
+        size_t at = stmt.find(compute_at, i);
+        if (at != string::npos) {
+            size_t j = skip_whitespace(stmt, at + compute_at.size());
+            d.placement = Placement::At;
+            d.consumer = read_identifier(stmt, j);
+        }
+        decisions[name] = d;
+    }
+
+    for (const auto &f : declared) {
+        if (!decisions.count(f)) {
+            decisions[f].placement = Placement::Inline;
+        }
+    }
+
+    return !decisions.empty();
+}
+
+bool ScheduleSeed::deviates(const FunctionDAG::Node *node, const LoopNest *root) const {
+    auto it = decisions.find(sanitize(node->func.name()));
+    if (it == decisions.end()) {
+        return false;
+    }
+
+    const LoopNest *site = find_compute_site(root, node);
+    if (!site) {
+        return it->second.placement != Placement::Inline;
+    } else if (site->is_root()) {
+        return it->second.placement != Placement::Root;
+    } else {
+        return (it->second.placement != Placement::At ||
+                it->second.consumer != sanitize(site->node->func.name()));
+    }
+}
+
+std::unique_ptr<ScheduleSeed> load_schedule_seed(const string &filename, int radius) {
+    std::ifstream f(filename);
+    user_assert(f.is_open()) << "Unable to open schedule seed file: " << filename << "\n";
+    std::stringstream contents;
+    contents << f.rdbuf();
+
+    std::unique_ptr<ScheduleSeed> seed(new ScheduleSeed);
+    seed->radius = radius;
+    user_assert(seed->parse(contents.str())) << "No schedule found in schedule seed file: " << filename << "\n";
+    return seed;
+}
+
+}  // namespace Autoscheduler
+}  // namespace Internal
+}  // namespace Halide
@@ -0,0 +1,61 @@
+#ifndef SCHEDULE_SEED_H
+#define SCHEDULE_SEED_H
+
+// A schedule previously emitted by the autoscheduler, parsed back into
+// the per-Func decisions that the beam search makes. It is used to
+// warm-start the search, so that re-tuning a pipeline after a small
+// edit only explores the neighborhood of the old schedule.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "FunctionDAG.h"
+#include "LoopNest.h"
+
+namespace Halide {
+namespace Internal {
+namespace Autoscheduler {
+
+struct ScheduleSeed {
+    // Where a Func was realized in the seed schedule.
+    enum class Placement {
+        Inline,
+        Root,
+        At
+    };
+
+    struct Decision {
+        Placement placement = Placement::Root;
+        // The Func it was computed at, if placement is Placement::At.
+        std::string consumer;
+    };
+
+    // Decisions indexed by Func name, with '$' replaced by '_' as in
+    // the emitted source.
+    std::map<std::string, Decision> decisions;
+
+    // The number of Funcs whose placement may differ from the seed.
+    int radius = 0;
+
+    // Parse schedule source in the format written by
+    // State::apply_schedule, either bare (as in HL_SCHEDULE_FILE) or
+    // wrapped in a .schedule.h file. Returns false if no Funcs were
+    // found.
+    bool parse(const std::string &source);
+
+    // Does the placement of 'node' in the loop nest 'root' differ from
+    // the seed? Funcs that the seed doesn't mention (e.g. ones added
+    // to the pipeline since it was generated) never differ.
+    bool deviates(const FunctionDAG::Node *node, const LoopNest *root) const;
+};
+
+// Read and parse a schedule seed from a file. Fails with a user error if
+// the file can't be read or contains no schedule.
+std::unique_ptr<ScheduleSeed> load_schedule_seed(const std::string &filename, int radius);
+
+}  // namespace Autoscheduler
+}  // namespace Internal
+}  // namespace Halide
+
+#endif  // SCHEDULE_SEED_H
@@ -0,0 +1,40 @@
+#include "SimulatedGPUCostModel.h"
+
+namespace Halide {
+
+using Internal::Autoscheduler::simulate_stage_runtime;
+
+void SimulatedGPUCostModel::set_pipeline_features(const Internal::Autoscheduler::FunctionDAG &dag,
+                                                  const MachineParams &params) {
+    internal_assert(params.parallelism > 0);
+    sim_params.num_sms = params.parallelism;
+}
+
+void SimulatedGPUCostModel::enqueue(const Internal::Autoscheduler::FunctionDAG &dag,
+                                    const Halide::Internal::Autoscheduler::StageMapOfScheduleFeatures &schedule_feats,
+                                    double *cost_ptr) {
+    double runtime = 0;
+    for (auto it = schedule_feats.begin(); it != schedule_feats.end(); it++) {
+        // The algorithm-specific features live on the stage itself.
+        runtime += simulate_stage_runtime(it.key()->features, it.value(), sim_params);
+    }
+    // Report the cost in milliseconds, like the learned model.
+    queue.emplace_back(runtime * 1000, cost_ptr);
+}
+
+void SimulatedGPUCostModel::evaluate_costs() {
+    for (const auto &q : queue) {
+        *(q.second) = q.first;
+    }
+    queue.clear();
+}
+
+void SimulatedGPUCostModel::reset() {
+    queue.clear();
+}
+
+std::unique_ptr<SimulatedGPUCostModel> make_simulated_gpu_cost_model() {
+    return std::unique_ptr<SimulatedGPUCostModel>(new SimulatedGPUCostModel());
+}
+
+}  // namespace Halide
@@ -0,0 +1,49 @@
+#ifndef SIMULATED_GPU_COST_MODEL_H
+#define SIMULATED_GPU_COST_MODEL_H
+
+#include "CostModel.h"
+#include "GPUSimulation.h"
+
+#include <utility>
+#include <vector>
+
+namespace Halide {
+
+// A cost model for GPU schedules that needs neither a GPU nor trained
+// weights: the cost of a schedule is the sum of the simulated
+// runtimes (in milliseconds) of its stages. See GPUSimulation.h.
+class SimulatedGPUCostModel : public CostModel {
+private:
+    Internal::Autoscheduler::GPUSimulationParams sim_params;
+    // Simulated costs waiting to be written back by evaluate_costs.
+    std::vector<std::pair<double, double *>> queue;
+
+public:
+    SimulatedGPUCostModel() = default;
+    ~SimulatedGPUCostModel() override = default;
+
+    // Configure the cost model for the algorithm to be scheduled.
+    // The parallelism of the machine params is taken to be the
+    // number of SMs.
+    void set_pipeline_features(const Internal::Autoscheduler::FunctionDAG &dag,
+                               const MachineParams &params) override;
+
+    // Enqueue a schedule to be evaluated. The simulation is cheap, so
+    // it is done immediately, but the result is only written to
+    // cost_ptr when evaluate_costs is called.
+    void enqueue(const Internal::Autoscheduler::FunctionDAG &dag,
+                 const Halide::Internal::Autoscheduler::StageMapOfScheduleFeatures &schedule_feats,
+                 double *cost_ptr) override;
+
+    // Evaluate all schedules in the queue.
+    void evaluate_costs() override;
+
+    // Discard all schedules in the queue.
+    void reset() override;
+};
+
+std::unique_ptr<SimulatedGPUCostModel> make_simulated_gpu_cost_model();
+
+}  // namespace Halide
+
+#endif  // SIMULATED_GPU_COST_MODEL_H
@@ -160,19 +160,10 @@ bool State::calculate_cost(const FunctionDAG &dag, const MachineParams &params,
     }
 
     // Apply the hard limit on memory use
-    if (memory_limit >= 0) {
-        int64_t mem_used = (int64_t)features.begin().value().working_set_at_root;
-        for (auto it = features.begin(); it != features.end(); it++) {
-            if (it.key()->node->is_output ||
-                it.key()->node->is_input) {
-                // Not allocated by this pipeline
-                mem_used -= it.value().bytes_at_production;
-            }
-        }
-        if (mem_used > memory_limit) {
-            cost = 1e50;
-            return false;
-        }
+    peak_memory = root->peak_memory(params);
+    if (memory_limit >= 0 && peak_memory > memory_limit) {
+        cost = 1e50;
+        return false;
     }
 
     // Tell the cost model about this state. It won't actually
@@ -195,6 +186,7 @@ IntrusivePtr<State> State::make_child() const {
     s->root = root;
     s->cost = cost;
     s->num_decisions_made = num_decisions_made;
+    s->seed_distance = seed_distance;
     return s;
 }
 
@@ -204,7 +196,8 @@ void State::generate_children(const FunctionDAG &dag,
                               CostModel *cost_model,
                               int64_t memory_limit,
                               std::function<void(IntrusivePtr<State> &&)> &accept_child,
-                              Cache *cache) const {
+                              Cache *cache,
+                              const ScheduleSeed *seed) const {
 
     internal_assert(root.defined() && root->is_root()) << "generate_children needs defined root\n";
 
@@ -259,6 +252,46 @@ void State::generate_children(const FunctionDAG &dag,
     int num_children = 0;
 
     if (phase == 0) {
+        // Cost a candidate placement of this Func, and accept it if
+        // it's not pruned.
+        auto accept_placement = [&](IntrusivePtr<State> &&child) {
+            if (child->calculate_cost(dag, params, cost_model, cache->options, memory_limit)) {
+                num_children++;
+                accept_child(std::move(child));
+            }
+        };
+
+        // If we're searching the neighborhood of a seed schedule, hold
+        // on to the placements of this Func until we've seen them
+        // all. Placements that differ from the seed move the state
+        // further from it, and are only considered while within the
+        // seed's radius. If the seed's placement is no longer possible
+        // (e.g. the pipeline changed), consider everything rather than
+        // running out of states.
+        vector<IntrusivePtr<State>> placements;
+        auto consider_placement = [&](IntrusivePtr<State> &&child) {
+            if (!seed) {
+                accept_placement(std::move(child));
+                return;
+            }
+            if (seed->deviates(node, child->root.get())) {
+                child->seed_distance++;
+            }
+            placements.emplace_back(std::move(child));
+        };
+        auto flush_placements = [&]() {
+            bool any_within_radius = false;
+            for (const auto &child : placements) {
+                any_within_radius |= child->seed_distance <= seed->radius;
+            }
+            for (auto &child : placements) {
+                if (!any_within_radius || child->seed_distance <= seed->radius) {
+                    accept_placement(std::move(child));
+                }
+            }
+            placements.clear();
+        };
+
         // Injecting realizations
         {
             // 1) Inline it
@@ -269,10 +302,7 @@ void State::generate_children(const FunctionDAG &dag,
                 new_root->inline_func(node);
                 child->root = new_root;
                 child->num_decisions_made++;
-                if (child->calculate_cost(dag, params, cost_model, cache->options, memory_limit)) {
-                    num_children++;
-                    accept_child(std::move(child));
-                }
+                consider_placement(std::move(child));
             }
         }
 
@@ -281,7 +311,7 @@ void State::generate_children(const FunctionDAG &dag,
         // inlining it is legal, just inline it. This saves time
         // on long chains of pointwise things.
         bool must_inline = (node->is_pointwise &&
-                            (num_children > 0) &&
+                            (num_children > 0 || !placements.empty()) &&
                             (node->outgoing_edges.size() == 1));
         if (must_inline) {
             for (const auto *e : node->stages[0].incoming_edges) {
@@ -292,6 +322,7 @@ void State::generate_children(const FunctionDAG &dag,
                                 e->consumer->node->is_boundary_condition);
             }
             if (must_inline) {
+                flush_placements();
                 return;
             }
         }
@@ -351,12 +382,10 @@ void State::generate_children(const FunctionDAG &dag,
                 auto child = make_child();
                 child->root = std::move(n);
                 child->num_decisions_made++;
-                if (child->calculate_cost(dag, params, cost_model, cache->options, memory_limit)) {
-                    num_children++;
-                    accept_child(std::move(child));
-                }
+                consider_placement(std::move(child));
             }
         }
+        flush_placements();
     } else {
         // We are parallelizing the loops of the func we just injected a realization for.
 
@@ -528,8 +557,18 @@ void State::generate_children(const FunctionDAG &dag,
     }
 }
 
+void State::apply_memory_budget(int64_t memory_budget) {
+    if (memory_budget <= 0 || peak_memory <= memory_budget) {
+        return;
+    }
+    // Penalize proportionately to the overshoot, so that states that
+    // fit in the budget are preferred, but the search can still make
+    // progress if nothing does.
+    cost *= (double)peak_memory / (double)memory_budget;
+}
+
 void State::dump() const {
-    aslog(0) << "State with cost " << cost << ":\n";
+    aslog(0) << "State with cost " << cost << ", predicted peak memory " << peak_memory << " bytes:\n";
     root->dump("", nullptr);
     aslog(0) << schedule_source;
 }
@@ -539,7 +578,8 @@ void State::dump() const {
 // user to copy-paste to freeze this schedule as permanent artifact.
 void State::apply_schedule(const FunctionDAG &dag, const MachineParams &params) {
     StageMap<std::unique_ptr<LoopNest::StageScheduleState>> state_map;
-    root->apply(LoopLevel::root(), state_map, params.parallelism, 0, nullptr, nullptr);
+    root->apply(LoopLevel::root(), state_map, params.parallelism, 0, nullptr, nullptr, dag.target, false);
+    const bool gpu = dag.target.has_gpu_feature();
 
     std::ostringstream src;
 
@@ -642,8 +682,21 @@ void State::apply_schedule(const FunctionDAG &dag, const MachineParams &params)
                 stage.fuse(parallel_vars[i], parallel_vars[i - 1], parallel_vars[i]);
             }
             if (!parallel_vars.empty()) {
-                p.second->schedule_source << "\n    .parallel(" << parallel_vars.back().name() << ")";
-                stage.parallel(parallel_vars.back());
+                if (gpu) {
+                    p.second->schedule_source << "\n    .gpu_blocks(" << parallel_vars.back().name() << ")";
+                    stage.gpu_blocks(parallel_vars.back());
+                } else {
+                    p.second->schedule_source << "\n    .parallel(" << parallel_vars.back().name() << ")";
+                    stage.parallel(parallel_vars.back());
+                }
+            }
+        } else if (gpu) {
+            // There can be at most three block dimensions. Use the
+            // innermost ones, and leave any others serial.
+            size_t first = parallel_vars.size() > 3 ? parallel_vars.size() - 3 : 0;
+            for (size_t i = first; i < parallel_vars.size(); i++) {
+                p.second->schedule_source << "\n    .gpu_blocks(" << parallel_vars[i].name() << ")";
+                stage.gpu_blocks(parallel_vars[i]);
             }
         } else {
             for (const auto &v : parallel_vars) {
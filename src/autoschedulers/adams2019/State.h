@@ -9,6 +9,7 @@
 #include "Halide.h"
 #include "LoopNest.h"
 #include "PerfectHashMap.h"
+#include "ScheduleSeed.h"
 #include <map>
 #include <utility>
 
@@ -30,6 +31,12 @@ struct State {
     int num_decisions_made = 0;
     // Penalization is determined based on structural hash during beam search.
     bool penalized = false;
+    // Estimated peak memory allocated by the pipeline under this
+    // schedule, in bytes. Computed by `calculate_cost`.
+    int64_t peak_memory = 0;
+    // Number of Funcs placed differently to the seed schedule, if
+    // the search was seeded.
+    int seed_distance = 0;
 
     // The C++ source code of the generated schedule for this State.
     // Computed if `apply_schedule` is called.
@@ -65,6 +72,8 @@ struct State {
     // Performs some pruning to decide if this state is worth queuing in
     // the cost_model. If it is, calls `cost_model->enqueue` and returns true,
     // otherwise sets `cost` equal to a large value and returns false.
+    // Also updates `peak_memory`, and rejects the state if it exceeds
+    // `memory_limit` (when non-negative).
     bool calculate_cost(const FunctionDAG &dag, const MachineParams &params,
                         CostModel *cost_model, const CachingOptions &cache_options,
                         int64_t memory_limit, bool verbose = false);
@@ -77,13 +86,21 @@ struct State {
 
     // Generate the successor states to this state.
     // If they are not pruned by `calculate_cost()`,
-    // then calls `accept_child()` on them.
+    // then calls `accept_child()` on them. If `seed` is
+    // non-null, only placements within its radius are generated.
     void generate_children(const FunctionDAG &dag,
                            const MachineParams &params,
                            CostModel *cost_model,
                            int64_t memory_limit,
                            std::function<void(IntrusivePtr<State> &&)> &accept_child,
-                           Cache *cache) const;
+                           Cache *cache,
+                           const ScheduleSeed *seed) const;
+
+    // Scale the cost of this state according to how far its estimated
+    // peak memory exceeds the soft `memory_budget`. Must be called
+    // after the cost model has evaluated the cost. Does nothing if the
+    // budget is not positive.
+    void apply_memory_budget(int64_t memory_budget);
 
     // Dumps cost, the `root` LoopNest, and then `schedule_source` to `aslog(0)`.
     void dump() const;
@@ -1,13 +1,49 @@
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <string>
+
+#include "GPUSimulation.h"
+
+using namespace Halide::Internal;
+
+// Sum the simulated GPU runtimes (in seconds) of all the stages in a
+// featurization. A featurization is, for each stage, the schedule
+// features followed by the pipeline features, all stored as floats.
+double simulate_runtime(const std::string &featurization) {
+    const size_t num_schedule_features = ScheduleFeatures::num_features();
+    const size_t num_pipeline_features = PipelineFeatures::num_features();
+    const size_t floats_per_stage = num_schedule_features + num_pipeline_features;
+    const size_t num_stages = featurization.size() / (floats_per_stage * sizeof(float));
+
+    Autoscheduler::GPUSimulationParams params;
+    const float *data = (const float *)featurization.data();
+    double runtime = 0;
+    for (size_t s = 0; s < num_stages; s++) {
+        const float *stage = data + s * floats_per_stage;
+        ScheduleFeatures sched_feat;
+        for (size_t i = 0; i < num_schedule_features; i++) {
+            sched_feat[i] = stage[i];
+        }
+        PipelineFeatures pipeline_feat;
+        for (size_t i = 0; i < num_pipeline_features; i++) {
+            pipeline_feat[i] = (int)stage[num_schedule_features + i];
+        }
+        runtime += Autoscheduler::simulate_stage_runtime(pipeline_feat, sched_feat, params);
+    }
+    return runtime;
+}
 
 // A sample is a featurization + a runtime + some ids, all together in one file.
 // This utility concats the runtime and ids onto a featurization to produce a sample.
+// If the runtime is given as "simulate", the runtime on a GPU is estimated
+// from the featurization instead, using the model in GPUSimulation.h.
 int main(int argc, char **argv) {
     if (argc != 6) {
-        std::cout << "Usage: featurization_to_sample in.featurization runtime pipeline_id schedule_id out.sample\n";
+        std::cout << "Usage: featurization_to_sample in.featurization (runtime|simulate) pipeline_id schedule_id out.sample\n";
         return -1;
     }
 
@@ -23,11 +59,14 @@ int main(int argc, char **argv) {
         return -1;
     }
 
-    dst << src.rdbuf();
+    std::stringstream featurization;
+    featurization << src.rdbuf();
+    dst << featurization.str();
 
     // Input runtime value is presumed to be in seconds,
     // but sample file stores times in milliseconds.
-    float r = atof(argv[2]) * 1000.f;
+    double runtime = (strcmp(argv[2], "simulate") == 0) ? simulate_runtime(featurization.str()) : atof(argv[2]);
+    float r = runtime * 1000.f;
     int32_t pid = atoi(argv[3]);
     int32_t sid = atoi(argv[4]);
 
@@ -2,6 +2,8 @@
 #include <cstdlib>   // setenv (or Windows _putenv_s)
 #include <iostream>  // std::cerr / std::endl
 #include <map>       // std::map
+#include <set>       // std::set
+#include <sstream>   // std::istringstream
 #include <string>    // std::to_string
 
 using namespace Halide;
@@ -53,6 +55,22 @@ bool test_caching(Pipeline &p1, Pipeline &p2, const Target &target, const Machin
     return true;
 }
 
+// Extract the compute_root/compute_at decision of each Func from
+// emitted schedule source.
+std::set<std::string> compute_placements(const std::string &schedule_source) {
+    std::set<std::string> result;
+    std::istringstream lines(schedule_source);
+    std::string line, func;
+    while (std::getline(lines, line)) {
+        if (!line.empty() && line[0] != ' ' && line.find(' ') == std::string::npos) {
+            func = line;
+        } else if (line.find(".compute_") != std::string::npos) {
+            result.insert(func + line);
+        }
+    }
+    return result;
+}
+
 int main(int argc, char **argv) {
     if (argc != 2) {
         fprintf(stderr, "Usage: %s <autoscheduler-lib>\n", argv[0]);
@@ -880,6 +898,73 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (true) {
+        // Schedule a stencil chain for a GPU target. This uses the
+        // simulated GPU cost model, and should produce a schedule
+        // that lowers cleanly (no GPU is needed to lower).
+        Target gpu_target("x86-64-linux-sse41-avx-avx2-cuda");
+        MachineParams gpu_params(40, 16000000, 40);
+
+        ImageParam im(Float(32), 2);
+        Func in("in"), f("f"), g("g"), h("h");
+        in(x, y) = im(x, y);
+        f(x, y) = in(x - 1, y) + in(x, y) + in(x + 1, y);
+        g(x, y) = f(x, y - 1) + f(x, y) + f(x, y + 1);
+        h(x, y) = g(x, y) * 2;
+
+        h.set_estimate(x, 0, 2048).set_estimate(y, 0, 2048);
+        im.set_estimates({{-1, 2050}, {-1, 2050}});
+
+        Pipeline p(h);
+        p.auto_schedule(gpu_target, gpu_params);
+        p.compile_to_module(p.infer_arguments(), "", gpu_target);
+    }
+
+    if (true) {
+        // Re-tune a stencil chain, seeded with its own schedule. With
+        // the default radius of zero, every Func must be placed as it
+        // was in the seed.
+        Pipeline p1;
+        Pipeline p2;
+        for (int test_condition = 0; test_condition < 2; test_condition++) {
+            const int N = 6;
+            // The seed refers to Funcs by name, so both pipelines
+            // must use the same names.
+            Func f[N];
+            for (int i = 0; i < N; i++) {
+                f[i] = Func("f" + std::to_string(i));
+            }
+            f[0](x, y) = (x + y) * (x + 2 * y) * (x + 3 * y);
+            for (int i = 1; i < N; i++) {
+                f[i](x, y) = f[i - 1](x - 1, y - 1) + f[i - 1](x + 1, y + 1);
+            }
+            f[N - 1].set_estimate(x, 0, 2048).set_estimate(y, 0, 2048);
+
+            if (test_condition) {
+                p2 = Pipeline(f[N - 1]);
+            } else {
+                p1 = Pipeline(f[N - 1]);
+            }
+        }
+
+        auto seed_results = p1.auto_schedule(target, params);
+        Internal::TemporaryFile seed_file("seed", ".schedule.h");
+        Internal::write_entire_file(seed_file.pathname(),
+                                    seed_results.schedule_source.data(),
+                                    seed_results.schedule_source.size());
+
+        set_env_variable("HL_SCHEDULE_SEED", seed_file.pathname(), /* overwrite */ 1);
+        auto results = p2.auto_schedule(target, params);
+        set_env_variable("HL_SCHEDULE_SEED", "", /* overwrite */ 1);
+
+        if (compute_placements(results.schedule_source) != compute_placements(seed_results.schedule_source)) {
+            std::cerr << "Seeded schedule does not match the placements of the seed:\n"
+                      << seed_results.schedule_source << "\nvs\n"
+                      << results.schedule_source << std::endl;
+            return 1;
+        }
+    }
+
     // Reset environment variables.
     set_env_variable("HL_DISABLE_MEMOIZED_FEATURES", cache_features, /* overwrite */ 1);
     set_env_variable("HL_DISABLE_MEMOIZED_BLOCKS", cache_blocks, /* overwrite */ 1);
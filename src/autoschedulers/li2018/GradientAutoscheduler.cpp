@@ -55,6 +55,108 @@ std::vector<int> get_rvar_bounds(const std::vector<ReductionVariable> &rvars) {
     return rvar_bounds;
 }
 
+// Find the Funcs that are consumed element-wise by more than one
+// other Func, such as intermediates shared by several gradients of a
+// backpropagation pipeline. inline_all_element_wise_functions only
+// handles the single-consumer case. For each one, use a simple
+// analytical model to decide whether fusing it into its consumers is
+// cheaper than computing it at root: inlining recomputes each point
+// once per extra call site, while computing it at root stores each
+// point and loads it back once per call site. Loads are weighted by
+// the machine's balance. Inline the first Func for which fusion wins
+// and return true, or return false if there is none.
+bool inline_element_wise_functions_by_cost(const std::vector<Function> &outputs,
+                                           const std::vector<std::string> &order,
+                                           const std::map<std::string, Function> &env,
+                                           const MachineParams &params) {
+    std::set<std::string> output_set;
+    for (const auto &output : outputs) {
+        output_set.insert(output.name());
+    }
+
+    RegionCosts costs(env, order);
+    for (size_t i = 0; i < order.size(); i++) {
+        const Function &f1 = env.at(order[i]);
+        if (output_set.count(order[i]) ||
+            f1.has_extern_definition() ||
+            !f1.can_be_inlined() ||
+            !f1.updates().empty()) {
+            continue;
+        }
+
+        // Count the call sites, and check they are all element-wise.
+        int call_sites = 0;
+        bool element_wise = true;
+        std::vector<Function> consumers;
+        for (size_t j = i + 1; j < order.size() && element_wise; j++) {
+            const Function &f2 = env.at(order[j]);
+            if (f2.has_extern_definition()) {
+                // Extern stages need their inputs realized.
+                for (const ExternFuncArgument &arg : f2.extern_arguments()) {
+                    if (arg.is_func() && Function(arg.func).name() == f1.name()) {
+                        element_wise = false;
+                    }
+                }
+                continue;
+            }
+            bool calls_f1 = false;
+            int num_stages = f2.updates().size() + 1;
+            for (int s = 0; s < num_stages && element_wise; s++) {
+                Definition def = get_stage_definition(f2, s);
+                FindAllCalls find;
+                def.accept(&find);
+                for (const auto &iter : find.call_args) {
+                    if (iter.first != f1.name()) {
+                        continue;
+                    }
+                    calls_f1 = true;
+                    call_sites++;
+                    if (def.args().size() != iter.second.size()) {
+                        element_wise = false;
+                        break;
+                    }
+                    for (size_t k = 0; k < iter.second.size(); k++) {
+                        if (!equal(def.args()[k], iter.second[k])) {
+                            element_wise = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (calls_f1) {
+                consumers.push_back(f2);
+            }
+        }
+        if (!element_wise || consumers.size() < 2) {
+            continue;
+        }
+
+        Cost cost = costs.get_func_stage_cost(f1, 0);
+        cost.simplify();
+        const int64_t *arith = as_const_int(cost.arith);
+        const int64_t *memory = as_const_int(cost.memory);
+        if (arith == nullptr || memory == nullptr) {
+            continue;
+        }
+        int bytes_per_point = 0;
+        for (const Type &t : f1.output_types()) {
+            bytes_per_point += t.bytes();
+        }
+        const double inline_cost = (call_sites - 1) * (*arith + params.balance * *memory);
+        const double root_cost = params.balance * bytes_per_point * (1 + call_sites);
+        debug(1) << "[gradient_autoscheduler] " << f1.name() << " is consumed element-wise at "
+                 << call_sites << " call sites, cost if inlined: " << inline_cost
+                 << ", cost if computed at root: " << root_cost << "\n";
+        if (inline_cost < root_cost) {
+            for (const Function &f2 : consumers) {
+                inline_function(f2, f1);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
 void reorder_storage(Func func,
                      const std::vector<Var> &all_vars,
                      std::ostringstream &schedule_source) {
@@ -571,6 +673,7 @@ void apply_schedule(const MachineParams &params,
                     int update_id,
                     const std::vector<int> &var_bounds,
                     bool is_gpu,
+                    RegionCosts &costs,
                     std::ostringstream &schedule_source) {
     if (update_id == -1) {
         func.compute_root();
@@ -633,15 +736,48 @@ void apply_schedule(const MachineParams &params,
                 is_associative = prover_result.associative();
                 if (is_associative) {
                     schedule_source << func.name() << ".update(" << update_id << ")\n";
+                    // Pick the tile size of each RVar. Start with split_size
+                    // = 8 * n where n is an integer and split_size >
+                    // sqrt(rvar_bounds), which balances the parallelism of
+                    // the outer loops against the work of the inner ones.
+                    std::vector<int> split_sizes(rvars.size(), 0);
+                    for (int i = 0; i < (int)rvars.size(); i++) {
+                        if (rvar_bounds[i] >= 8) {
+                            float target = std::sqrt(rvar_bounds[i]);
+                            split_sizes[i] = int(std::ceil(target / 8.f)) * 8;
+                        }
+                    }
+                    // For large reductions, shrink the tiles until the
+                    // values loaded by one tile of the inner reduction fit in
+                    // one core's share of the last level cache.
+                    Cost cost = costs.get_func_stage_cost(func.function(), update_id + 1);
+                    cost.simplify();
+                    const int64_t *bytes_per_iteration = as_const_int(cost.memory);
+                    if (!is_gpu && bytes_per_iteration != nullptr && params.last_level_cache_size > 0) {
+                        const int64_t cache_per_core =
+                            params.last_level_cache_size / std::max(1, params.parallelism);
+                        while (true) {
+                            int64_t footprint = *bytes_per_iteration;
+                            int largest = -1;
+                            for (int i = 0; i < (int)rvars.size(); i++) {
+                                footprint *= split_sizes[i] > 0 ? split_sizes[i] : rvar_bounds[i];
+                                if (split_sizes[i] > 8 &&
+                                    (largest == -1 || split_sizes[i] > split_sizes[largest])) {
+                                    largest = i;
+                                }
+                            }
+                            if (footprint <= cache_per_core || largest == -1) {
+                                break;
+                            }
+                            split_sizes[largest] = std::max(8, (split_sizes[largest] / 2 + 7) / 8 * 8);
+                        }
+                    }
                     // Generate a list of tiled RVars
                     std::vector<RVar> outer_rvars, inner_rvars;
                     std::vector<int> outer_rvar_sizes, inner_rvar_sizes;
                     for (int i = 0; i < (int)rvars.size(); i++) {
-                        if (rvar_bounds[i] >= 8) {
-                            // Let split_size = 8 * n where n is an integer and
-                            // split_size > sqrt(rvar_bounds)
-                            float target = std::sqrt(rvar_bounds[i]);
-                            int split_size = int(std::ceil(target / 8.f)) * 8;
+                        if (split_sizes[i] > 0) {
+                            const int split_size = split_sizes[i];
                             // Split the rvar
                             RVar outer, inner;
                             func.update(update_id)
@@ -655,8 +791,7 @@ void apply_schedule(const MachineParams &params,
                                             << TailStrategy::GuardWithIf << ")\n";
                             outer_rvars.push_back(outer);
                             inner_rvars.push_back(inner);
-                            int outer_size = rvar_bounds[i] % split_size == 0 ? split_size : split_size + 1;
-                            outer_rvar_sizes.push_back(outer_size);
+                            outer_rvar_sizes.push_back((rvar_bounds[i] + split_size - 1) / split_size);
                             inner_rvar_sizes.push_back(split_size);
                         } else {
                             inner_rvars.push_back(rvars[i]);
@@ -863,6 +998,17 @@ void generate_schedule(const std::vector<Function> &outputs,
         }
         order = realization_order(outputs, env).first;
     }
+    // Fuse element-wise producers with several consumers into those
+    // consumers, where that's cheaper than realizing them.
+    while (inline_element_wise_functions_by_cost(outputs, order, env, params)) {
+        env.clear();
+        for (const Function &f : outputs) {
+            std::map<std::string, Function> more_funcs = find_transitive_calls(f);
+            env.insert(more_funcs.begin(), more_funcs.end());
+        }
+        order = realization_order(outputs, env).first;
+    }
+    RegionCosts costs(env, order);
 
     // Bounds inference using the given estimation
     std::vector<Box> output_bounds_expr;
@@ -915,11 +1061,11 @@ void generate_schedule(const std::vector<Function> &outputs,
         Box bounds = func_bounds[*it];
         std::vector<int> int_bounds = get_int_bounds(bounds);
         // Scheduling pure definition
-        apply_schedule(params, target, func, -1, int_bounds, target.has_gpu_feature(), schedule_source);
+        apply_schedule(params, target, func, -1, int_bounds, target.has_gpu_feature(), costs, schedule_source);
         // Scheduling the updates
         for (int update_id = 0;
              update_id < func.num_update_definitions(); update_id++) {
-            apply_schedule(params, target, func, update_id, int_bounds, target.has_gpu_feature(), schedule_source);
+            apply_schedule(params, target, func, update_id, int_bounds, target.has_gpu_feature(), costs, schedule_source);
         }
     }
 
@@ -151,5 +151,51 @@ int main(int argc, char **argv) {
         std::cout << "Schedule for 2D pointwise operations with small x dimension:\n"
                   << result.schedule_source << "\n\n";
     }
+
+    {  // Gradient pipeline with multiple outputs. The forward pass
+        // intermediate is consumed by both gradients.
+        Buffer<float> a_buf(1000, 1000), b_buf(1000, 1000);
+        Func a("a"), b("b");
+        a(x, y) = a_buf(x, y);
+        b(x, y) = b_buf(x, y);
+        Func prod("prod");
+        prod(x, y) = a(x, y) * b(x, y);
+        Func act("act");
+        act(x, y) = tanh(prod(x, y));
+        RDom r(0, 1000, 0, 1000);
+        Func loss("loss");
+        loss() = 0.f;
+        loss() += act(r.x, r.y) * act(r.x, r.y);
+
+        Derivative d = propagate_adjoints(loss);
+        Func da = d(a);
+        Func db = d(b);
+        da.set_estimate(x, 0, 1000)
+            .set_estimate(y, 0, 1000);
+        db.set_estimate(x, 0, 1000)
+            .set_estimate(y, 0, 1000);
+
+        AutoSchedulerResults result =
+            Pipeline({da, db}).auto_schedule(target, params);
+        std::cout << "Schedule for multi-output gradient pipeline:\n"
+                  << result.schedule_source << "\n\n";
+    }
+
+    {  // Large reduction over a small output. Should rfactor, with
+        // the reduction tiled to fit in cache.
+        Func in("in");
+        in(x, y) = cast<float>(x + y);
+        RDom r(0, 4000, 0, 4000);
+        Func total("total");
+        total(x) = 0.f;
+        total(x) += in(r.x, r.y) * cast<float>(x + 1);
+
+        total.set_estimate(x, 0, 4);
+
+        AutoSchedulerResults result =
+            Pipeline(total).auto_schedule(target, params);
+        std::cout << "Schedule for large reduction:\n"
+                  << result.schedule_source << "\n\n";
+    }
     return 0;
 }
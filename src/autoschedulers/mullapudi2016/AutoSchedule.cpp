@@ -1,7 +1,10 @@
 #include "HalidePlugin.h"
 
 #include <algorithm>
+#include <exception>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <set>
 #include <utility>
@@ -178,18 +181,38 @@ struct DependenceAnalysis {
             return prods < other.prods;
         }
     };
-    struct RegionsRequired {
-        DimBounds bounds;
-        // Regions required to compute 'bounds' given a particular
-        // RegionsRequiredQuery.
-        map<string, Box> regions;
-        RegionsRequired(const DimBounds &b, const map<string, Box> &r)
-            : bounds(b), regions(r) {
+    // A structural ordering on bounds, so that queries for the same region
+    // hit in the cache even if the bounds were constructed separately.
+    struct DimBoundsCompare {
+        bool operator()(const DimBounds &a, const DimBounds &b) const {
+            if (a.size() != b.size()) {
+                return a.size() < b.size();
+            }
+            IRDeepCompare cmp;
+            for (auto ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib) {
+                if (ia->first != ib->first) {
+                    return ia->first < ib->first;
+                }
+                if (cmp(ia->second.min, ib->second.min)) {
+                    return true;
+                } else if (cmp(ib->second.min, ia->second.min)) {
+                    return false;
+                }
+                if (cmp(ia->second.max, ib->second.max)) {
+                    return true;
+                } else if (cmp(ib->second.max, ia->second.max)) {
+                    return false;
+                }
+            }
+            return false;
         }
     };
     // Cache for bounds queries (bound queries with the same parameters are
-    // common during the grouping process).
-    map<RegionsRequiredQuery, vector<RegionsRequired>> regions_required_cache;
+    // common during the grouping process). Maps each query to the regions
+    // required to compute a given set of bounds. Guarded by 'cache_mutex',
+    // since group analyses are evaluated concurrently.
+    map<RegionsRequiredQuery, map<DimBounds, map<string, Box>, DimBoundsCompare>> regions_required_cache;
+    std::unique_ptr<std::mutex> cache_mutex = std::make_unique<std::mutex>();
 
     DependenceAnalysis(const map<string, Function> &env, const vector<string> &order,
                        const FuncValueBounds &func_val_bounds)
@@ -386,13 +409,14 @@ DependenceAnalysis::regions_required(const Function &f, int stage_num,
 
     // Check the cache if we've already computed this previously.
     RegionsRequiredQuery query(f.name(), stage_num, prods, only_regions_computed);
-    const auto &iter = regions_required_cache.find(query);
-    if (iter != regions_required_cache.end()) {
-        const auto &it = std::find_if(iter->second.begin(), iter->second.end(),
-                                      [&bounds](const RegionsRequired &r) { return (r.bounds == bounds); });
-        if (it != iter->second.end()) {
-            internal_assert((iter->first == query) && (it->bounds == bounds));
-            return it->regions;
+    {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        const auto &iter = regions_required_cache.find(query);
+        if (iter != regions_required_cache.end()) {
+            const auto &it = iter->second.find(bounds);
+            if (it != iter->second.end()) {
+                return it->second;
+            }
         }
     }
 
@@ -574,7 +598,10 @@ DependenceAnalysis::regions_required(const Function &f, int stage_num,
         concrete_regions[f_reg.first] = concrete_box;
     }
 
-    regions_required_cache[query].push_back(RegionsRequired(bounds, concrete_regions));
+    {
+        std::lock_guard<std::mutex> lock(*cache_mutex);
+        regions_required_cache[query].emplace(bounds, concrete_regions);
+    }
     return concrete_regions;
 }
 
@@ -982,6 +1009,10 @@ struct Partitioner {
         // Estimate of the parallelism that can be exploited while computing
         // the group.
         Expr parallelism;
+        // Estimate of the peak amount of memory (in bytes) allocated for the
+        // intermediates of the group while computing it. This accounts for
+        // one set of tile buffers per concurrently running task.
+        Expr peak_memory;
 
         GroupAnalysis()
             : cost(Cost()), parallelism(Expr()) {
@@ -999,12 +1030,16 @@ struct Partitioner {
             if (parallelism.defined()) {
                 parallelism = Internal::simplify(parallelism);
             }
+            if (peak_memory.defined()) {
+                peak_memory = Internal::simplify(peak_memory);
+            }
         }
 
         friend std::ostream &operator<<(std::ostream &stream, const GroupAnalysis &analysis) {
             stream << "[arith cost:" << analysis.cost.arith << ", "
                    << "memory cost:" << analysis.cost.memory << ", "
-                   << "parallelism:" << analysis.parallelism << "]\n";
+                   << "parallelism:" << analysis.parallelism << ", "
+                   << "peak memory:" << analysis.peak_memory << "]\n";
             return stream;
         }
     };
@@ -1063,6 +1098,16 @@ struct Partitioner {
     RegionCosts &costs;
     // Output functions of the pipeline.
     const vector<Function> &outputs;
+    // Upper bound (in bytes) on the predicted peak memory of the pipeline,
+    // taken from HL_AUTOSCHEDULE_MEMORY_LIMIT. Tile configurations whose
+    // intermediates would exceed it are rejected. Negative means no limit.
+    int64_t memory_limit = -1;
+    // Number of threads used to evaluate grouping choices and tile
+    // configurations concurrently, taken from HL_AUTOSCHEDULE_NUM_THREADS.
+    // Defaults to the number of cores.
+    int num_threads = 1;
+    // Lazily-created pool of 'num_threads' worker threads.
+    std::unique_ptr<ThreadPool<void>> thread_pool;
 
     Partitioner(const map<string, Box> &_pipeline_bounds,
                 const MachineParams &_arch_params,
@@ -1072,6 +1117,11 @@ struct Partitioner {
 
     void initialize_groups();
 
+    // Call 'body' on every index in [0, n). The calls are distributed across
+    // the thread pool, unless there is only one thread or the caller is itself
+    // running on the pool, in which case they are made serially.
+    void parallel_for(int n, const std::function<void(int)> &body);
+
     // Merge 'prod_group' into 'cons_group'. The output stage of 'cons_group'
     // will be the output stage of the merged group.
     Group merge_groups(const Group &prod_group, const Group &cons_group);
@@ -1147,6 +1197,14 @@ struct Partitioner {
     // groups within the pipeline.
     Cost get_pipeline_cost();
 
+    // Return the estimated peak memory (in bytes) allocated by the pipeline:
+    // the full buffers of all non-output group outputs, which are computed at
+    // root, plus the largest set of per-tile intermediates of any group.
+    Expr get_pipeline_peak_memory();
+
+    // Return true if 'analysis' is known to exceed the memory limit.
+    bool exceeds_memory_limit(const GroupAnalysis &analysis) const;
+
     // Return the maximum access stride to allocation of 'func_acc' along any
     // loop variable specified in 'vars'. Access expressions along each dimension
     // of the allocation are specified by 'acc_exprs'. The dimension bounds of the
@@ -1178,6 +1236,20 @@ struct Partitioner {
     // auto scheduling.
     void generate_cpu_schedule(const Target &t, AutoSchedule &sched);
 
+    // Fuse the loop nests of sibling groups (groups which do not depend on
+    // each other but consume a common producer) using compute_with, so that
+    // the producer is read once by all of them while it is still in cache.
+    // This is applied as a post process after the schedules of all the groups
+    // have been generated, since it requires the loop nests of the groups
+    // being fused to match from the outermost loop to the fused loop.
+    void fuse_sibling_groups(AutoSchedule &sched);
+
+    // The tile loop of each group output at which the other members of the
+    // group are computed. Fusion must stop outside of this loop, since only
+    // the first stage in a fused loop nest can serve as a compute_at level
+    // for the fused loops.
+    map<string, string> group_compute_levels;
+
     // Same as \ref Partitioner::generate_cpu_schedule, but this generates and
     // applies schedules for a group of function stages.
 
@@ -1216,6 +1288,47 @@ struct Partitioner {
     void disp_grouping();
 };
 
+// Set on the worker threads of a Partitioner's thread pool, so that nested
+// calls to parallel_for don't block the pool waiting on itself.
+thread_local bool in_partitioner_worker = false;
+
+void Partitioner::parallel_for(int n, const std::function<void(int)> &body) {
+    if (num_threads <= 1 || n <= 1 || in_partitioner_worker) {
+        for (int i = 0; i < n; i++) {
+            body(i);
+        }
+        return;
+    }
+
+    if (!thread_pool) {
+        thread_pool = std::make_unique<ThreadPool<void>>(num_threads);
+    }
+
+    // Errors raised on a worker are rethrown on the calling thread.
+    vector<std::exception_ptr> errors(n);
+    vector<std::future<void>> futures;
+    futures.reserve(n);
+    for (int i = 0; i < n; i++) {
+        futures.push_back(thread_pool->async([&body, &errors, i]() {
+            in_partitioner_worker = true;
+            try {
+                body(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+            in_partitioner_worker = false;
+        }));
+    }
+    for (auto &f : futures) {
+        f.get();
+    }
+    for (const auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
 void Partitioner::disp_grouping() {
     debug(0) << "\n=========\n"
              << "Grouping:\n"
@@ -1267,6 +1380,40 @@ Cost Partitioner::get_pipeline_cost() {
     return total_cost;
 }
 
+Expr Partitioner::get_pipeline_peak_memory() {
+    Expr root_allocations = make_zero(Int(64));
+    Expr max_intermediates = make_zero(Int(64));
+    for (const pair<const FStage, Group> &g : groups) {
+        const GroupAnalysis &analysis = get_element(group_costs, g.first);
+        if (!analysis.peak_memory.defined()) {
+            return Expr();
+        }
+        max_intermediates = max(max_intermediates, analysis.peak_memory);
+
+        const string &name = g.first.func.name();
+        bool is_output = false;
+        for (const Function &f : outputs) {
+            is_output |= (f.name() == name);
+        }
+        // Only count each Func once, at its final stage.
+        const Function &f = get_element(dep_analysis.env, name);
+        if (is_output || (g.first.stage_num != f.updates().size())) {
+            continue;
+        }
+        Expr size = costs.region_size(name, get_element(pipeline_bounds, name));
+        if (!size.defined()) {
+            return Expr();
+        }
+        root_allocations += size;
+    }
+    return simplify(root_allocations + max_intermediates);
+}
+
+bool Partitioner::exceeds_memory_limit(const GroupAnalysis &analysis) const {
+    return (memory_limit >= 0) && analysis.peak_memory.defined() &&
+           can_prove(analysis.peak_memory > make_const(Int(64), memory_limit));
+}
+
 void Partitioner::disp_pipeline_costs() {
     internal_assert(!group_costs.empty());
     Cost total_cost(0, 0);
@@ -1299,6 +1446,7 @@ void Partitioner::disp_pipeline_costs() {
     total_cost.simplify();
     debug(0) << "Total arithmetic cost: " << total_cost.arith << "\n"
              << "Total memory cost: " << total_cost.memory << "\n"
+             << "Predicted peak memory: " << get_pipeline_peak_memory() << "\n"
              << "===============\n";
 }
 
@@ -1311,6 +1459,17 @@ Partitioner::Partitioner(const map<string, Box> &_pipeline_bounds,
                          RegionCosts &_costs)
     : pipeline_bounds(_pipeline_bounds), arch_params(_arch_params),
       dep_analysis(_dep_analysis), costs(_costs), outputs(_outputs) {
+    string memory_limit_str = get_env_variable("HL_AUTOSCHEDULE_MEMORY_LIMIT");
+    if (!memory_limit_str.empty()) {
+        memory_limit = std::atoll(memory_limit_str.c_str());
+    }
+    string num_threads_str = get_env_variable("HL_AUTOSCHEDULE_NUM_THREADS");
+    if (!num_threads_str.empty()) {
+        num_threads = std::max(1, std::atoi(num_threads_str.c_str()));
+    } else {
+        num_threads = std::max((size_t)1, ThreadPool<void>::num_processors_online());
+    }
+
     // Place each stage of a function in its own group. Each stage is
     // a node in the pipeline graph.
     for (const auto &f : dep_analysis.env) {
@@ -1420,6 +1579,29 @@ Partitioner::choose_candidate_grouping(const vector<pair<string, string>> &cands
                                        Partitioner::Level level) {
     vector<pair<GroupingChoice, GroupConfig>> best_grouping;
     Expr best_benefit = make_zero(Int(64));
+
+    // Evaluate all the choices that haven't been evaluated before up front,
+    // in parallel, and add them to the cache.
+    vector<GroupingChoice> to_evaluate;
+    for (const auto &p : cands) {
+        const Function &prod_f = get_element(dep_analysis.env, p.first);
+        FStage prod(prod_f, prod_f.updates().size());
+        for (const FStage &c : get_element(children, prod)) {
+            GroupingChoice cand_choice(prod_f.name(), c);
+            if (!grouping_cache.count(cand_choice) &&
+                std::find(to_evaluate.begin(), to_evaluate.end(), cand_choice) == to_evaluate.end()) {
+                to_evaluate.push_back(cand_choice);
+            }
+        }
+    }
+    vector<GroupConfig> evaluated(to_evaluate.size());
+    parallel_for((int)to_evaluate.size(), [&](int i) {
+        evaluated[i] = evaluate_choice(to_evaluate[i], level);
+    });
+    for (size_t i = 0; i < to_evaluate.size(); i++) {
+        grouping_cache.emplace(to_evaluate[i], evaluated[i]);
+    }
+
     for (const auto &p : cands) {
         // Compute the aggregate benefit of inlining into all the children.
         vector<pair<GroupingChoice, GroupConfig>> grouping;
@@ -1598,16 +1780,35 @@ Partitioner::find_best_tile_config(const Group &g) {
     // Generate tiling configurations
     vector<map<string, Expr>> configs = generate_tile_configs(g.output);
 
+    // Analyze all the configurations in parallel. The choice among them is
+    // made serially below, in order, so the result is deterministic.
+    vector<GroupAnalysis> analyses(configs.size());
+    parallel_for((int)configs.size(), [&](int i) {
+        Group new_group = g;
+        new_group.tile_sizes = configs[i];
+        analyses[i] = analyze_group(new_group, show_analysis);
+    });
+
     Group best_group = g;
-    for (const auto &config : configs) {
+    for (size_t i = 0; i < configs.size(); i++) {
+        const auto &config = configs[i];
         Group new_group = g;
         new_group.tile_sizes = config;
 
-        GroupAnalysis new_analysis = analyze_group(new_group, show_analysis);
+        const GroupAnalysis &new_analysis = analyses[i];
+
+        if (exceeds_memory_limit(new_analysis)) {
+            debug(3) << "Rejecting tile config that exceeds the memory limit:" << new_analysis;
+            continue;
+        }
 
         bool no_redundant_work = false;
         Expr benefit = estimate_benefit(best_analysis, new_analysis,
                                         no_redundant_work, true);
+        if (exceeds_memory_limit(best_analysis) && new_analysis.defined()) {
+            // Anything that fits is better than the current best
+            benefit = make_one(Int(64));
+        }
 
         if (show_analysis) {
             debug(0) << "Benefit relative to not tiling:" << benefit << "\n";
@@ -2028,6 +2229,21 @@ Partitioner::GroupAnalysis Partitioner::analyze_group(const Group &g, bool show_
     GroupAnalysis g_analysis(
         Cost(per_tile_cost.arith * estimate_tiles, per_tile_cost.memory * estimate_tiles),
         parallelism);
+
+    // The intermediates of the group are allocated per tile. Each task
+    // running in parallel holds its own set of them.
+    map<string, Box> intermediate_regions;
+    for (const auto &reg : alloc_regions) {
+        if ((group_members.find(reg.first) != group_members.end()) &&
+            (reg.first != g.output.func.name())) {
+            intermediate_regions.emplace(reg.first, reg.second);
+        }
+    }
+    Expr tile_footprint = costs.region_footprint(intermediate_regions, g.inlined);
+    if (tile_footprint.defined()) {
+        Expr concurrent_tasks = min(parallelism, make_const(Int(64), arch_params.parallelism));
+        g_analysis.peak_memory = tile_footprint * max(concurrent_tasks, make_one(Int(64)));
+    }
     g_analysis.simplify();
 
     return g_analysis;
@@ -2789,6 +3005,7 @@ void Partitioner::generate_group_cpu_schedule(
         string var_name = get_base_name(dims[tile_inner_index].var);
         bool is_rvar = (rvars.find(var_name) != rvars.end());
         tile_inner_var = VarOrRVar(var_name, is_rvar);
+        group_compute_levels[g_out.name()] = var_name;
     }
 
     for (const FStage &mem : g.members) {
@@ -2882,6 +3099,171 @@ void Partitioner::generate_cpu_schedule(const Target &t, AutoSchedule &sched) {
         generate_group_cpu_schedule(g.second, t, get_element(loop_bounds, g.first),
                                     get_element(storage_bounds, g.first), inlines, sched);
     }
+
+    fuse_sibling_groups(sched);
+}
+
+void Partitioner::fuse_sibling_groups(AutoSchedule &sched) {
+    // Only the outputs of groups with a single pure definition are
+    // considered for fusion. Functions with extern definitions cannot be
+    // fused, and the child of a fused pair cannot have specializations.
+    vector<const Group *> candidates;
+    for (const pair<const FStage, Group> &g : groups) {
+        const Function &f = g.second.output.func;
+        if (!f.has_extern_definition() && f.updates().empty() &&
+            f.definition().specializations().empty() &&
+            pipeline_bounds.find(f.name()) != pipeline_bounds.end()) {
+            candidates.push_back(&g.second);
+        }
+    }
+
+    // Find the functions and images read by each candidate group from
+    // outside of the group, and all the functions each of them depends on.
+    map<string, set<string>> group_reads;
+    map<string, map<string, Function>> group_deps;
+    for (const Group *g : candidates) {
+        FindAllCalls find;
+        set<string> members;
+        for (const FStage &s : g->members) {
+            get_stage_definition(s.func, s.stage_num).accept(&find);
+            members.insert(s.func.name());
+        }
+        const string &name = g->output.func.name();
+        for (const string &f : find.funcs_called) {
+            if (members.find(f) == members.end()) {
+                group_reads[name].insert(f);
+            }
+        }
+        group_deps[name] = find_transitive_calls(g->output.func);
+    }
+
+    // Return true if reading 'prod' from both of the fused loop nests saves
+    // a trip to memory, i.e. if the region of 'prod' read by the pipeline is
+    // not known to fit in the last level cache. Images are assumed to be
+    // large enough.
+    auto fusion_saves_traffic = [&](const string &prod) {
+        const auto &iter = pipeline_bounds.find(prod);
+        const auto &f_iter = dep_analysis.env.find(prod);
+        if (iter == pipeline_bounds.end() || f_iter == dep_analysis.env.end()) {
+            return true;
+        }
+        Expr size = box_size(iter->second);
+        if (!size.defined()) {
+            return true;
+        }
+        int64_t bytes_per_ele = 0;
+        for (const auto &type : f_iter->second.output_types()) {
+            bytes_per_ele += type.bytes();
+        }
+        Expr footprint = simplify(size * make_const(Int(64), bytes_per_ele));
+        return !can_prove(footprint <= make_const(Int(64), arch_params.last_level_cache_size));
+    };
+
+    auto same_bounds = [&](const string &f1, const string &f2) {
+        const Box &b1 = get_element(pipeline_bounds, f1);
+        const Box &b2 = get_element(pipeline_bounds, f2);
+        if (b1.size() != b2.size()) {
+            return false;
+        }
+        for (size_t d = 0; d < b1.size(); d++) {
+            if (!b1[d].is_bounded() || !b2[d].is_bounded() ||
+                !can_prove(b1[d].min == b2[d].min) ||
+                !can_prove(b1[d].max == b2[d].max)) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    // Return the innermost loop of 'child' that can be fused with 'parent',
+    // or an empty string if none. The loop nests of both need to match from
+    // the outermost loop to the fused loop, excluding vector loops and the
+    // loop at which the members of 'child' are computed.
+    auto find_fuse_var = [&](const Function &parent, const Function &child) {
+        const vector<Dim> &p_dims = parent.definition().schedule().dims();
+        const vector<Dim> &c_dims = child.definition().schedule().dims();
+        const auto &level = group_compute_levels.find(child.name());
+        string fuse_var;
+        // Ignore __outermost
+        int n = std::min(p_dims.size(), c_dims.size()) - 1;
+        for (int i = 2; i <= n + 1; i++) {
+            const Dim &p = p_dims[p_dims.size() - i];
+            const Dim &c = c_dims[c_dims.size() - i];
+            string var = get_base_name(c.var);
+            if ((get_base_name(p.var) != var) ||
+                (p.for_type != c.for_type) ||
+                (p.device_api != c.device_api) ||
+                (p.dim_type != c.dim_type) ||
+                (c.for_type == ForType::Vectorized) ||
+                ((level != group_compute_levels.end()) && (level->second == var))) {
+                break;
+            }
+            fuse_var = var;
+        }
+        return fuse_var;
+    };
+
+    // Greedily fuse each candidate with the first earlier candidate it is
+    // compatible with. All the members of a fused cluster must be
+    // independent of each other.
+    map<string, vector<string>> clusters;
+    set<string> fused_children;
+    for (const Group *parent : candidates) {
+        const Function &p_func = parent->output.func;
+        if (fused_children.count(p_func.name())) {
+            continue;
+        }
+        vector<string> &cluster = clusters[p_func.name()];
+        cluster.push_back(p_func.name());
+
+        for (const Group *child : candidates) {
+            const Function &c_func = child->output.func;
+            if (c_func.same_as(p_func) || clusters.count(c_func.name()) ||
+                fused_children.count(c_func.name())) {
+                continue;
+            }
+
+            if (!(parent->tile_sizes == child->tile_sizes) ||
+                !same_bounds(p_func.name(), c_func.name())) {
+                continue;
+            }
+
+            bool independent = true;
+            for (const string &m : cluster) {
+                independent = independent &&
+                              !get_element(group_deps, c_func.name()).count(m) &&
+                              !get_element(group_deps, m).count(c_func.name());
+            }
+            if (!independent) {
+                continue;
+            }
+
+            bool beneficial = false;
+            for (const string &prod : get_element(group_reads, c_func.name())) {
+                if (get_element(group_reads, p_func.name()).count(prod)) {
+                    beneficial = beneficial || fusion_saves_traffic(prod);
+                }
+            }
+            if (!beneficial) {
+                continue;
+            }
+
+            string fuse_var = find_fuse_var(p_func, c_func);
+            if (fuse_var.empty()) {
+                continue;
+            }
+
+            debug(2) << "Fusing " << c_func.name() << " with " << p_func.name()
+                     << " at " << fuse_var << "\n";
+            Func(c_func).compute_with(Func(p_func), Var(fuse_var));
+            string sanitized_parent = get_sanitized_name(p_func.name());
+            sched.push_schedule(c_func.name(), 0,
+                                "compute_with(" + sanitized_parent + ", " + fuse_var + ")",
+                                {sanitized_parent, fuse_var});
+            cluster.push_back(c_func.name());
+            fused_children.insert(c_func.name());
+        }
+    }
 }
 
 Expr Partitioner::find_max_access_stride(const Scope<> &vars,
@@ -3351,6 +3733,8 @@ string generate_schedules(const vector<Function> &outputs, const Target &target,
         part.disp_pipeline_graph();
     }
 
+    debug(1) << "Predicted peak memory: " << part.get_pipeline_peak_memory() << " bytes\n";
+
     debug(2) << "Initializing AutoSchedule...\n";
     AutoSchedule sched(env, top_order);
     debug(2) << "Generating CPU schedule...\n";
@@ -1346,6 +1346,10 @@ typedef enum halide_target_feature_t {
     halide_llvm_large_code_model,                 ///< Use the LLVM large code model to compile
     halide_target_feature_rvv,                    ///< Enable RISCV "V" Vector Extension
     halide_target_feature_armv81a,                ///< Enable ARMv8.1-a instructions
+    halide_target_feature_auto_prefetch,          ///< Insert software prefetches for strided streams the hardware prefetcher is likely to miss.
+    halide_target_feature_specialize_dense_buffers,  ///< Multi-version pipelines with vector loops on whether their buffers are dense and aligned.
+    halide_target_feature_avxvnni,                ///< Enable the VEX-encoded AVX-VNNI dot product instructions. Implies AVX2.
+    halide_target_feature_multiversion,           ///< Also compile the vector loops of x86 pipelines for SSE4.1, AVX2 and AVX-512, and pick one at runtime.
     halide_target_feature_end                     ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
@@ -0,0 +1,12 @@
+declare i32 @llvm.wasm.memory.atomic.wait32(i32*, i32, i64)
+declare i32 @llvm.wasm.memory.atomic.notify(i32*, i32)
+
+define weak_odr i32 @halide_wasm_atomic_wait32(i32* %addr, i32 %expected, i64 %timeout_ns) nounwind alwaysinline {
+  %1 = tail call i32 @llvm.wasm.memory.atomic.wait32(i32* %addr, i32 %expected, i64 %timeout_ns)
+  ret i32 %1
+}
+
+define weak_odr i32 @halide_wasm_atomic_notify(i32* %addr, i32 %count) nounwind alwaysinline {
+  %1 = tail call i32 @llvm.wasm.memory.atomic.notify(i32* %addr, i32 %count)
+  ret i32 %1
+}
@@ -0,0 +1,186 @@
+#include "HalideRuntime.h"
+#include "runtime_internal.h"
+#include "scoped_spin_lock.h"
+
+// The thread pool for WebAssembly with shared memory and atomics. The
+// threads are still created with the pthreads provided by the wasm libc
+// (typically Emscripten), but the worker threads we spawn sleep and wake
+// with memory.atomic.wait32 and memory.atomic.notify directly. Other
+// threads may be the main thread of a browser, on which waiting traps,
+// so they go through the libc's condition variables instead.
+
+constexpr int MAX_THREADS = 256;
+
+extern "C" {
+
+// This code cannot depend on system headers, hence we choose a data size which will
+// be large enough for all systems we care about.
+// 64 bytes covers this for both mutex and condvar. Using int64_t ensures alignment.
+struct pthread_mutex_t {
+    uint64_t _private[8];
+};
+
+struct pthread_cond_t {
+    uint64_t _private[8];
+};
+
+typedef long pthread_t;
+extern int pthread_create(pthread_t *, const void *attr,
+                          void *(*start_routine)(void *), void *arg);
+extern int pthread_join(pthread_t thread, void **retval);
+extern int pthread_cond_init(pthread_cond_t *cond, const void *attr);
+extern int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+extern int pthread_cond_signal(pthread_cond_t *cond);
+extern int pthread_cond_destroy(pthread_cond_t *cond);
+extern int pthread_mutex_init(pthread_mutex_t *mutex, const void *attr);
+extern int pthread_mutex_lock(pthread_mutex_t *mutex);
+extern int pthread_mutex_unlock(pthread_mutex_t *mutex);
+extern int pthread_mutex_destroy(pthread_mutex_t *mutex);
+
+typedef unsigned int pthread_key_t;
+
+extern int pthread_key_create(pthread_key_t *key, void (*destructor)(void *));
+extern int pthread_setspecific(pthread_key_t key, const void *value);
+extern void *pthread_getspecific(pthread_key_t key);
+
+// Defined in wasm_atomics.ll
+extern int halide_wasm_atomic_wait32(int *addr, int expected, int64_t timeout_ns);
+extern int halide_wasm_atomic_notify(int *addr, int count);
+
+}  // extern "C"
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+// Set to a non-null value on the threads we spawned.
+WEAK pthread_key_t spawned_thread_key;
+WEAK bool spawned_thread_key_created = false;
+WEAK ScopedSpinLock::AtomicFlag spawned_thread_key_lock = 0;
+
+struct spawned_thread {
+    void (*f)(void *);
+    void *closure;
+    pthread_t handle;
+};
+WEAK void *spawn_thread_helper(void *arg) {
+    spawned_thread *t = (spawned_thread *)arg;
+    pthread_setspecific(spawned_thread_key, t);
+    t->f(t->closure);
+    return nullptr;
+}
+
+ALWAYS_INLINE bool on_spawned_thread() {
+    return spawned_thread_key_created && pthread_getspecific(spawned_thread_key) != nullptr;
+}
+
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+extern "C" {
+
+using namespace Halide::Runtime::Internal;
+
+WEAK struct halide_thread *halide_spawn_thread(void (*f)(void *), void *closure) {
+    {
+        ScopedSpinLock lock(&spawned_thread_key_lock);
+        if (!spawned_thread_key_created) {
+            pthread_key_create(&spawned_thread_key, nullptr);
+            spawned_thread_key_created = true;
+        }
+    }
+    spawned_thread *t = (spawned_thread *)malloc(sizeof(spawned_thread));
+    t->f = f;
+    t->closure = closure;
+    t->handle = 0;
+    pthread_create(&t->handle, nullptr, spawn_thread_helper, t);
+    return (halide_thread *)t;
+}
+
+WEAK void halide_join_thread(struct halide_thread *thread_arg) {
+    spawned_thread *t = (spawned_thread *)thread_arg;
+    void *ret = nullptr;
+    pthread_join(t->handle, &ret);
+    free(t);
+}
+}
+
+namespace Halide {
+namespace Runtime {
+namespace Internal {
+
+namespace Synchronization {
+
+struct thread_parker {
+    pthread_mutex_t mutex;
+    pthread_cond_t condvar;
+    // An int, rather than a bool, so that it can be waited on.
+    int should_park = 0;
+    bool use_atomic_wait;
+
+    thread_parker(const thread_parker &) = delete;
+    thread_parker &operator=(const thread_parker &) = delete;
+    thread_parker(thread_parker &&) = delete;
+    thread_parker &operator=(thread_parker &&) = delete;
+
+    ALWAYS_INLINE thread_parker()
+        : use_atomic_wait(on_spawned_thread()) {
+        pthread_mutex_init(&mutex, nullptr);
+        pthread_cond_init(&condvar, nullptr);
+    }
+
+    ALWAYS_INLINE ~thread_parker() {
+        pthread_cond_destroy(&condvar);
+        pthread_mutex_destroy(&mutex);
+    }
+
+    ALWAYS_INLINE void prepare_park() {
+        should_park = 1;
+    }
+
+    ALWAYS_INLINE void park() {
+        if (use_atomic_wait) {
+            while (__atomic_load_n(&should_park, __ATOMIC_ACQUIRE)) {
+                halide_wasm_atomic_wait32(&should_park, 1, -1);
+            }
+            // The unparker holds the mutex until it is done with this
+            // parker, which must outlive it.
+            pthread_mutex_lock(&mutex);
+            pthread_mutex_unlock(&mutex);
+            return;
+        }
+        pthread_mutex_lock(&mutex);
+        while (should_park) {
+            pthread_cond_wait(&condvar, &mutex);
+        }
+        pthread_mutex_unlock(&mutex);
+    }
+
+    ALWAYS_INLINE void unpark_start() {
+        pthread_mutex_lock(&mutex);
+    }
+
+    ALWAYS_INLINE void unpark() {
+        if (use_atomic_wait) {
+            __atomic_store_n(&should_park, 0, __ATOMIC_RELEASE);
+            halide_wasm_atomic_notify(&should_park, 1);
+        } else {
+            should_park = 0;
+            pthread_cond_signal(&condvar);
+        }
+    }
+
+    ALWAYS_INLINE void unpark_finish() {
+        pthread_mutex_unlock(&mutex);
+    }
+};
+
+}  // namespace Synchronization
+}  // namespace Internal
+}  // namespace Runtime
+}  // namespace Halide
+
+#include "synchronization_common.h"
+
+#include "thread_pool_common.h"
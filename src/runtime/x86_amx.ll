@@ -13,6 +13,20 @@ define weak_odr <512 x i16> @tileloadd64_bf16(i16 %rows, i16 %colbytes, i8* %ptr
   ret <512 x i16> %3
 }
 
+define weak_odr <256 x i32> @tileloadd64_i32(i16 %rows, i16 %colbytes, i8* %ptr, i64 %off, i64 %stride) nounwind alwaysinline readonly {
+  %1 = getelementptr i8, i8* %ptr, i64 %off
+  %2 = tail call x86_amx @llvm.x86.tileloadd64.internal(i16 %rows, i16 %colbytes, i8* %1, i64 %stride) nounwind readonly
+  %3 = bitcast x86_amx %2 to <256 x i32>
+  ret <256 x i32> %3
+}
+
+define weak_odr <256 x float> @tileloadd64_f32(i16 %rows, i16 %colbytes, i8* %ptr, i64 %off, i64 %stride) nounwind alwaysinline readonly {
+  %1 = getelementptr i8, i8* %ptr, i64 %off
+  %2 = tail call x86_amx @llvm.x86.tileloadd64.internal(i16 %rows, i16 %colbytes, i8* %1, i64 %stride) nounwind readonly
+  %3 = bitcast x86_amx %2 to <256 x float>
+  ret <256 x float> %3
+}
+
 define weak_odr <256 x i32> @tdpbssd(i16 %rows, i16 %colbytes, i16 %acc, <256 x i32> %out, <1024 x i8> %lhs, <1024 x i8> %rhs) nounwind alwaysinline readnone {
   %1 = bitcast <1024 x i8> %lhs to x86_amx
   %2 = bitcast <1024 x i8> %rhs to x86_amx
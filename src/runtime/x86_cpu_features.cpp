@@ -36,6 +36,7 @@ WEAK CpuFeatures halide_get_cpu_features() {
     features.set_known(halide_target_feature_avx512_skylake);
     features.set_known(halide_target_feature_avx512_cannonlake);
     features.set_known(halide_target_feature_avx512_sapphirerapids);
+    features.set_known(halide_target_feature_avxvnni);
 
     int32_t info[4];
     cpuid(info, 1);
@@ -78,6 +79,13 @@ WEAK CpuFeatures halide_get_cpu_features() {
         constexpr uint32_t avx512_cannonlake = avx512_skylake | avx512ifma;  // Assume ifma => vbmi
         if ((info2[1] & avx2) == avx2) {
             features.set_available(halide_target_feature_avx2);
+
+            constexpr uint32_t avxvnni = 1U << 4;  // avxvnni result in eax, cpuid(eax=7, ecx=1)
+            int32_t info3[4];
+            cpuid(info3, 7, 1);
+            if ((info3[0] & avxvnni) == avxvnni) {
+                features.set_available(halide_target_feature_avxvnni);
+            }
         }
         if ((info2[1] & avx512) == avx512) {
             features.set_available(halide_target_feature_avx512);
@@ -0,0 +1,78 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] Autoschedulers do not support WebAssembly.\n");
+        return 0;
+    }
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <autoscheduler-lib>\n", argv[0]);
+        return 1;
+    }
+
+    load_plugin(argv[1]);
+
+    int W = 3000;
+    int H = 2000;
+    Buffer<float> input(W + 1, H);
+
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = rand() & 0xfff;
+        }
+    }
+
+    Var x("x"), y("y");
+
+    // Two outputs which read the same input over the same domain, but
+    // don't depend on each other.
+    Func g("g");
+    g(x, y) = input(x, y) * 2 + input(x + 1, y);
+
+    Func h("h");
+    h(x, y) = input(x, y) * 3 - input(x + 1, y);
+
+    // Provide estimates on the pipeline outputs
+    g.set_estimate(x, 0, W).set_estimate(y, 0, H);
+    h.set_estimate(x, 0, W).set_estimate(y, 0, H);
+
+    // Auto-schedule the pipeline
+    Pipeline p({g, h});
+
+    Target target = get_jit_target_from_environment();
+    AutoSchedulerResults results = p.auto_schedule(target);
+
+    std::cout << "\n\n******************************************\nSCHEDULE:\n"
+              << "******************************************\n"
+              << results.schedule_source
+              << "\n******************************************\n\n";
+
+    // The input doesn't fit in cache, so both outputs should be computed
+    // in a single pass over it.
+    if (results.schedule_source.find("compute_with") == std::string::npos) {
+        printf("g and h were not fused\n");
+        return -1;
+    }
+
+    // Run the schedule
+    Buffer<float> out_g(W, H), out_h(W, H);
+    p.realize({out_g, out_h});
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            float correct_g = input(x, y) * 2 + input(x + 1, y);
+            float correct_h = input(x, y) * 3 - input(x + 1, y);
+            if (out_g(x, y) != correct_g || out_h(x, y) != correct_h) {
+                printf("out_g(%d, %d) = %f instead of %f, out_h(%d, %d) = %f instead of %f\n",
+                       x, y, out_g(x, y), correct_g, x, y, out_h(x, y), correct_h);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
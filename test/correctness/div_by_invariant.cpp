@@ -0,0 +1,123 @@
+#include "Halide.h"
+
+#include <random>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the vector divisions and modulos left in the lowered Stmt.
+class CountVectorDivisions : public IRMutator {
+    int &count;
+
+    using IRMutator::visit;
+
+    Expr visit(const Div *op) override {
+        count += op->type.is_vector();
+        return IRMutator::visit(op);
+    }
+
+    Expr visit(const Mod *op) override {
+        count += op->type.is_vector();
+        return IRMutator::visit(op);
+    }
+
+public:
+    CountVectorDivisions(int &count)
+        : count(count) {
+    }
+};
+
+// Halide's Euclidean division and modulo, with division by zero
+// defined to be zero.
+template<typename T>
+T correct_div(T a, T b) {
+    if (b == 0) {
+        return 0;
+    }
+    int64_t q = (int64_t)a / (int64_t)b;
+    if ((int64_t)a - q * (int64_t)b < 0) {
+        q += b > 0 ? -1 : 1;
+    }
+    return (T)q;
+}
+
+template<typename T>
+T correct_mod(T a, T b) {
+    if (b == 0) {
+        return 0;
+    }
+    int64_t r = (int64_t)a % (int64_t)b;
+    if (r < 0) {
+        r += b > 0 ? (int64_t)b : -(int64_t)b;
+    }
+    return (T)r;
+}
+
+template<typename T>
+bool test(int vector_width) {
+    Type t = halide_type_of<T>();
+
+    Buffer<T> input(vector_width * 16, 2);
+    std::mt19937 rng(0);
+    input.for_each_value([&](T &v) { v = (T)rng(); });
+    // Include the extremes.
+    input(0, 0) = t.is_int() ? (T)((uint64_t)1 << (t.bits() - 1)) : (T)0;
+    input(1, 0) = (T)(~(T)0);
+    input(2, 0) = (T)(((uint64_t)1 << (t.bits() - 1)) - 1);
+    input(3, 0) = 0;
+
+    Param<T> divisor;
+    Func f;
+    Var x, y;
+    f(x, y) = Tuple(input(x, y) / divisor, input(x, y) % divisor);
+    f.vectorize(x, vector_width);
+
+    int count = 0;
+    f.add_custom_lowering_pass(new CountVectorDivisions(count));
+    f.compile_jit();
+    if (count != 0) {
+        printf("Found %d vector divisions by a loop invariant %s\n", count, type_to_c_type(t, false).c_str());
+        return false;
+    }
+
+    std::vector<int64_t> divisors = {1, 2, 3, 7, 10, 64, 255, 0, (int64_t)rng(), (int64_t)(rng() & 0xff)};
+    if (t.is_int()) {
+        divisors.push_back(-1);
+        divisors.push_back(-3);
+        divisors.push_back(-128);
+        divisors.push_back(-((int64_t)1 << (t.bits() - 1)));
+    }
+    for (int64_t d : divisors) {
+        divisor.set((T)d);
+        Realization r = f.realize({input.width(), input.height()});
+        Buffer<T> q = r[0], m = r[1];
+        for (int yy = 0; yy < input.height(); yy++) {
+            for (int xx = 0; xx < input.width(); xx++) {
+                T a = input(xx, yy), b = (T)d;
+                if (q(xx, yy) != correct_div(a, b) || m(xx, yy) != correct_mod(a, b)) {
+                    printf("%lld / %lld = %lld, %lld %% %lld = %lld instead of %lld and %lld\n",
+                           (long long)a, (long long)b, (long long)q(xx, yy),
+                           (long long)a, (long long)b, (long long)m(xx, yy),
+                           (long long)correct_div(a, b), (long long)correct_mod(a, b));
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test<int32_t>(8) ||
+        !test<uint32_t>(8) ||
+        !test<int16_t>(16) ||
+        !test<uint16_t>(16) ||
+        !test<int8_t>(32) ||
+        !test<uint8_t>(32)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -1,6 +1,7 @@
 #include "Halide.h"
 
 #include <limits>
+#include <random>
 
 using namespace Halide;
 
@@ -15,6 +16,36 @@ bool check_infinity_case(bool use_first, float16_t value, const char *value_name
     return true;
 }
 
+// Chains of math on 16-bit floats must round after every operation,
+// however the intermediate values are held.
+template<typename T>
+bool check_chained_math(const char *type_name) {
+    std::mt19937 rng(0);
+    Buffer<T> a(1024), b(1024), c(1024);
+    for (Buffer<T> *buf : {&a, &b, &c}) {
+        buf->for_each_value([&](T &v) { v = T::make_from_bits((uint16_t)rng()); });
+    }
+
+    Var x;
+    Func f;
+    // No multiply feeds an add, which targets with native float16 math may fuse.
+    f(x) = (a(x) + c(x)) / (b(x) - c(x)) * a(x);
+    f.vectorize(x, 16);
+    Buffer<T> out = f.realize({1024});
+
+    for (int i = 0; i < 1024; i++) {
+        T ai = a(i), bi = b(i), ci = c(i);
+        T correct = (ai + ci) / (bi - ci) * ai;
+        if (correct.is_nan() != out(i).is_nan() ||
+            (!correct.is_nan() && correct.to_bits() != out(i).to_bits())) {
+            printf("Chained %s math at %d: 0x%x instead of 0x%x\n",
+                   type_name, i, out(i).to_bits(), correct.to_bits());
+            return false;
+        }
+    }
+    return true;
+}
+
 int main(int argc, char **argv) {
     Var x;
 
@@ -226,6 +257,11 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (!check_chained_math<float16_t>("float16") ||
+        !check_chained_math<bfloat16_t>("bfloat16")) {
+        return -1;
+    }
+
     // Enable to read assembly generated by the conversion routines
     if ((false)) {  // Intentional dead code. Extra parens to pacify clang-tidy.
         Func src, to_f16, from_f16;
@@ -0,0 +1,113 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int mallocs = 0;
+
+void *my_malloc(JITUserContext *user_context, size_t x) {
+    mallocs++;
+    void *orig = malloc(x + 32);
+    void *ptr = (void *)((((size_t)orig + 32) >> 5) << 5);
+    ((void **)ptr)[-1] = orig;
+    return ptr;
+}
+
+void my_free(JITUserContext *user_context, void *ptr) {
+    free(((void **)ptr)[-1]);
+}
+
+// Run a tiled pipeline where g is computed per tile of f, and check
+// the output and the number of allocations made.
+int run_test(int hoist, int expected_mallocs) {
+    Func f("f"), g("g");
+    Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi");
+    Param<int> tile_size;
+
+    g(x, y) = x * 2 + y;
+    f(x, y) = g(x, y) + g(x + 1, y + 1);
+
+    // A tile size that isn't known at compile time, so that g's
+    // allocation isn't constant-sized.
+    f.tile(x, y, xo, yo, xi, yi, tile_size, tile_size, TailStrategy::GuardWithIf);
+    g.compute_at(f, xo).store_in(MemoryType::Heap);
+    if (hoist == 1) {
+        g.hoist_storage(f, yo);
+    } else if (hoist == 2) {
+        g.hoist_storage_root();
+    }
+
+    f.jit_handlers().custom_malloc = my_malloc;
+    f.jit_handlers().custom_free = my_free;
+
+    tile_size.set(16);
+    mallocs = 0;
+    Buffer<int> out = f.realize({100, 90});
+
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            int correct = (x * 2 + y) + ((x + 1) * 2 + (y + 1));
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (mallocs != expected_mallocs) {
+        printf("Expected %d allocations with hoist mode %d, got %d\n",
+               expected_mallocs, hoist, mallocs);
+        return -1;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (get_jit_target_from_environment().arch == Target::WebAssembly) {
+        printf("[SKIP] WebAssembly JIT does not support custom allocators.\n");
+        return 0;
+    }
+
+    // 7 x 6 tiles
+    const int tiles_x = 7, tiles_y = 6;
+
+    // Allocated once per tile.
+    if (run_test(0, tiles_x * tiles_y) != 0) {
+        return -1;
+    }
+
+    // Allocated once per row of tiles.
+    if (run_test(1, tiles_y) != 0) {
+        return -1;
+    }
+
+    // Allocated once.
+    if (run_test(2, 1) != 0) {
+        return -1;
+    }
+
+    // Hoisting storage out of a parallel loop that it's stored inside
+    // is a race, but hoisting to the parallel loop itself is fine.
+    {
+        Func f("f"), g("g");
+        Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi");
+        g(x, y) = x * 2 + y;
+        f(x, y) = g(x, y) + g(x + 1, y + 1);
+        f.tile(x, y, xo, yo, xi, yi, 16, 16).parallel(yo);
+        g.compute_at(f, xo).hoist_storage(f, yo);
+        Buffer<int> out = f.realize({128, 128});
+        for (int y = 0; y < out.height(); y++) {
+            for (int x = 0; x < out.width(); x++) {
+                int correct = (x * 2 + y) + ((x + 1) * 2 + (y + 1));
+                if (out(x, y) != correct) {
+                    printf("out(%d, %d) = %d instead of %d\n", x, y, out(x, y), correct);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
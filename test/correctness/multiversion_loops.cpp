@@ -0,0 +1,61 @@
+#include "Halide.h"
+
+#include <cmath>
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.arch != Target::X86 || t.has_gpu_feature()) {
+        printf("[SKIP] Loop multiversioning only applies to x86 CPU targets.\n");
+        return 0;
+    }
+
+    // Compile for plain x86, so that the loops get a copy for each
+    // feature level, and the fastest one this machine has is used.
+    Target base = Target(t.os, t.arch, t.bits).with_feature(Target::Multiversion);
+
+    ImageParam in(Float(32), 2);
+    Param<float> scale;
+    Func f;
+    Var x, y;
+    f(x, y) = sqrt(in(x, y)) * scale + in(x, y);
+    f.vectorize(x, 16).parallel(y);
+
+    // One copy of the loop over x for each feature level, plus the
+    // plain one and the dispatcher.
+    Module m = f.compile_to_module(f.infer_arguments(), "f", base);
+    int versions = 0;
+    for (const LoweredFunc &fn : m.functions()) {
+        versions += !fn.extra_features.empty();
+    }
+    int expected = (int)get_multiversion_levels(base).size();
+    if (expected == 0 || versions != expected) {
+        printf("Found %d multiversioned functions instead of %d\n", versions, expected);
+        return -1;
+    }
+
+    Buffer<float> input(100, 20);
+    input.for_each_element([&](int x, int y) {
+        input(x, y) = x * 0.25f + y;
+    });
+    in.set(input);
+    scale.set(3.0f);
+
+    Buffer<float> out = f.realize({100, 20}, base);
+    for (int y = 0; y < out.height(); y++) {
+        for (int x = 0; x < out.width(); x++) {
+            float correct = std::sqrt(input(x, y)) * 3.0f + input(x, y);
+            // The copies for AVX2 and up may fuse the multiply-add.
+            if (std::abs(out(x, y) - correct) > 1e-5f * correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -111,6 +111,90 @@ int predicated_tail_test(const Target &t) {
     return 0;
 }
 
+template<typename T>
+int predicated_tail_every_length_test(const Target &t) {
+    // Two native vectors, so that the tail also covers the case where
+    // the whole of the second half is masked off.
+    const int vector_size = t.natural_vector_size<T>() * 2;
+
+    Var x("x");
+    Func f("f");
+    ImageParam p(type_of<T>(), 1);
+
+    f(x) = p(x) * 2 + 1;
+    f.vectorize(x, vector_size, TailStrategy::Predicate);
+    if (t.has_feature(Target::HVX)) {
+        f.hexagon();
+    }
+    f.compile_jit(t);
+
+    for (int size = 1; size <= 3 * vector_size; size++) {
+        Buffer<T> input(size);
+        input.for_each_element([&](int i) { input(i) = (T)i; });
+        p.set(input);
+
+        // Surround the output with sentinels, to check that the
+        // masked-off lanes aren't written.
+        const T sentinel = (T)123;
+        Buffer<T> padded(size + vector_size);
+        padded.fill(sentinel);
+        Buffer<T> out(padded.get()->cropped(0, 0, size));
+        f.realize(out);
+
+        for (int i = 0; i < size + vector_size; i++) {
+            T correct = i < size ? (T)((T)i * 2 + 1) : sentinel;
+            if (padded(i) != correct) {
+                printf("Size %d: padded(%d) = %f instead of %f\n",
+                       size, i, (double)padded(i), (double)correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int predicated_tail_two_loads_test(const Target &t) {
+    // With more than one predicated load, CSE lifts their shared
+    // predicate into a let.
+    const int vector_size = t.natural_vector_size<float>() * 2;
+
+    Var x("x");
+    Func f("f");
+    ImageParam p(Float(32), 1), q(Float(32), 1);
+
+    f(x) = p(x) * 2 + q(x);
+    f.vectorize(x, vector_size, TailStrategy::Predicate);
+    if (t.has_feature(Target::HVX)) {
+        f.hexagon();
+    }
+    f.add_custom_lowering_pass(new CheckPredicatedStoreLoad(1, 2));
+    f.compile_jit(t);
+
+    for (int size = 1; size <= 3 * vector_size; size++) {
+        Buffer<float> a(size), b(size);
+        a.for_each_element([&](int i) { a(i) = (float)i; });
+        b.for_each_element([&](int i) { b(i) = (float)(i % 7); });
+        p.set(a);
+        q.set(b);
+
+        const float sentinel = 123.0f;
+        Buffer<float> padded(size + vector_size);
+        padded.fill(sentinel);
+        Buffer<float> out(padded.get()->cropped(0, 0, size));
+        f.realize(out);
+
+        for (int i = 0; i < size + vector_size; i++) {
+            float correct = i < size ? i * 2.0f + (i % 7) : sentinel;
+            if (padded(i) != correct) {
+                printf("Size %d: padded(%d) = %f instead of %f\n",
+                       size, i, padded(i), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
 int predicated_tail_with_scalar_test(const Target &t) {
     int size = 73;
     Var x("x"), y("y");
@@ -474,6 +558,19 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    printf("Running predicated tail of every length test\n");
+    if (predicated_tail_every_length_test<uint8_t>(t) != 0 ||
+        predicated_tail_every_length_test<int16_t>(t) != 0 ||
+        predicated_tail_every_length_test<float>(t) != 0 ||
+        predicated_tail_every_length_test<double>(t) != 0) {
+        return -1;
+    }
+
+    printf("Running predicated tail with two loads test\n");
+    if (predicated_tail_two_loads_test(t) != 0) {
+        return -1;
+    }
+
     printf("Running vectorized dense load with scalar test\n");
     if (predicated_tail_with_scalar_test(t) != 0) {
         return -1;
@@ -469,6 +469,55 @@ int test12(const Target &t) {
     return 0;
 }
 
+int test13(const Target &t) {
+    if (t.arch == Target::Hexagon || t.arch == Target::WebAssembly) {
+        return 0;
+    }
+
+    // Reading down the columns of an input has a stride only known at
+    // runtime, so should be prefetched automatically.
+    ImageParam in(Float(32), 2, "in");
+    Func g("g");
+    Var x("x"), y("y");
+
+    g(x, y) = in(y, x);
+
+    for (bool auto_prefetch : {false, true}) {
+        Target target = auto_prefetch ? t.with_feature(Target::AutoPrefetch) : t;
+        Module m = g.compile_to_module({in}, "", target);
+        CollectPrefetches collect;
+        m.functions()[0].body.accept(&collect);
+
+        vector<vector<Expr>> expected;
+        if (auto_prefetch) {
+            expected.push_back({Variable::make(Handle(), in.name()), wild<int>(), 1, 16});
+        }
+        if (!check(expected, collect.prefetches)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int test14(const Target &t) {
+    // Dense streams are left to the hardware prefetcher.
+    ImageParam in(Float(32), 2, "in");
+    Func g("g");
+    Var x("x"), y("y");
+
+    g(x, y) = in(x, y) * 2.0f;
+
+    Module m = g.compile_to_module({in}, "", t.with_feature(Target::AutoPrefetch));
+    CollectPrefetches collect;
+    m.functions()[0].body.accept(&collect);
+
+    vector<vector<Expr>> expected;
+    if (!check(expected, collect.prefetches)) {
+        return -1;
+    }
+    return 0;
+}
+
 }  // anonymous namespace
 
 int main(int argc, char **argv) {
@@ -476,7 +525,7 @@ int main(int argc, char **argv) {
     std::cout << "Testing target: " << t << "\n";
 
     using Fn = int (*)(const Target &t);
-    std::vector<Fn> tests = {test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12};
+    std::vector<Fn> tests = {test1, test2, test3, test4, test5, test6, test7, test8, test9, test10, test11, test12, test13, test14};
 
     for (size_t i = 0; i < tests.size(); i++) {
         printf("Running prefetch test %d\n", (int)i + 1);
@@ -0,0 +1,152 @@
+#include "Halide.h"
+
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Check that the loops over the entries of a row start and end inside
+// the loop over the rows, instead of covering every row's entries.
+class CheckRaggedLoops : public IRMutator {
+    bool &tightened;
+    // The row loop variables, and the lets defined inside row loops.
+    std::vector<std::string> row_vars;
+    int row_loops = 0;
+
+    using IRMutator::visit;
+
+    Stmt visit(const For *op) override {
+        bool is_row = ends_with(op->name, "$y");
+        if (ends_with(op->name, "$x") && row_loops > 0) {
+            for (const std::string &v : row_vars) {
+                tightened |= expr_uses_var(op->min, v) || expr_uses_var(op->extent, v);
+            }
+        }
+        if (!is_row) {
+            return IRMutator::visit(op);
+        }
+        row_loops++;
+        row_vars.push_back(op->name);
+        Stmt s = IRMutator::visit(op);
+        row_vars.pop_back();
+        row_loops--;
+        return s;
+    }
+
+    Stmt visit(const LetStmt *op) override {
+        if (row_loops == 0) {
+            return IRMutator::visit(op);
+        }
+        row_vars.push_back(op->name);
+        Stmt s = IRMutator::visit(op);
+        row_vars.pop_back();
+        return s;
+    }
+
+public:
+    CheckRaggedLoops(bool &tightened)
+        : tightened(tightened) {
+    }
+};
+
+int main(int argc, char **argv) {
+    // A 6x8 sparse matrix in the CSR format, with some empty rows.
+    const int rows = 6, cols = 8;
+    const int row_offsets_data[] = {0, 3, 3, 4, 9, 9, 11};
+    const int column_data[] = {0, 2, 7, 5, 0, 1, 2, 3, 4, 6, 7};
+    const int nnz = row_offsets_data[rows];
+
+    Buffer<int> row_offsets(rows + 1), columns(nnz);
+    Buffer<float> values(nnz), x(cols);
+    for (int i = 0; i <= rows; i++) {
+        row_offsets(i) = row_offsets_data[i];
+    }
+    for (int i = 0; i < nnz; i++) {
+        columns(i) = column_data[i];
+        values(i) = i + 1;
+    }
+    for (int i = 0; i < cols; i++) {
+        x(i) = i * 0.5f - 1;
+    }
+
+    // Sparse matrix-vector product
+    {
+        RDom r = RDom::ragged(row_offsets);
+        Func y;
+        Var i;
+        y(i) = 0.0f;
+        y(r.y) += values(r.x) * x(clamp(columns(r.x), 0, cols - 1));
+
+        bool tightened = false;
+        y.add_custom_lowering_pass(new CheckRaggedLoops(tightened));
+        Buffer<float> result = y.realize({rows});
+        if (!tightened) {
+            printf("The loop over the entries of a row was not tightened to the row\n");
+            return -1;
+        }
+
+        for (int row = 0; row < rows; row++) {
+            float correct = 0.0f;
+            for (int j = row_offsets(row); j < row_offsets(row + 1); j++) {
+                correct += values(j) * x(columns(j));
+            }
+            if (result(row) != correct) {
+                printf("y(%d) = %f instead of %f\n", row, result(row), correct);
+                return -1;
+            }
+        }
+    }
+
+    // A ragged batch with variable-length rows, vectorized across each
+    // row. Each entry records the row it belongs to.
+    {
+        ImageParam offsets(Int(32), 1);
+        RDom r = RDom::ragged(offsets);
+        Func f;
+        Var i;
+        f(i) = -1;
+        f(r.x) = r.y * 100 + r.x;
+        f.update().vectorize(r.x, 4);
+
+        bool tightened = false;
+        f.add_custom_lowering_pass(new CheckRaggedLoops(tightened));
+        offsets.set(row_offsets);
+        Buffer<int> result = f.realize({nnz});
+        if (!tightened) {
+            printf("The vectorized loop over the entries of a row was not tightened to the row\n");
+            return -1;
+        }
+
+        for (int row = 0; row < rows; row++) {
+            for (int j = row_offsets(row); j < row_offsets(row + 1); j++) {
+                if (result(j) != row * 100 + j) {
+                    printf("f(%d) = %d instead of %d\n", j, result(j), row * 100 + j);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // If the loop over the rows is inside the loop over the entries, the
+    // predicates must be evaluated as usual.
+    {
+        RDom r = RDom::ragged(row_offsets);
+        Func count;
+        Var i;
+        count(i) = 0;
+        count(r.y) += 1;
+        count.update().reorder(r.y, r.x);
+
+        Buffer<int> result = count.realize({rows});
+        for (int row = 0; row < rows; row++) {
+            int correct = row_offsets(row + 1) - row_offsets(row);
+            if (result(row) != correct) {
+                printf("count(%d) = %d instead of %d\n", row, result(row), correct);
+                return -1;
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "Halide.h"
+
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the allocations promoted to single vector registers.
+class CountRegisterTiles : public IRMutator {
+    int &count;
+
+    using IRMutator::visit;
+
+    Stmt visit(const Allocate *op) override {
+        if (op->memory_type == MemoryType::Register &&
+            op->name.find(".reg") != std::string::npos) {
+            count++;
+        }
+        return IRMutator::visit(op);
+    }
+
+public:
+    CountRegisterTiles(int &count)
+        : count(count) {
+    }
+};
+
+int test_matmul(bool unroll_tile, MemoryType memory_type, int expected_tiles) {
+    Target t = get_jit_target_from_environment();
+    const int vec = t.natural_vector_size<float>();
+    const int size = 128;
+
+    Buffer<float> a(size, size), b(size, size);
+    a.for_each_element([&](int x, int y) { a(x, y) = (float)((x + 3 * y) % 7); });
+    b.for_each_element([&](int x, int y) { b(x, y) = (float)((2 * x + y) % 5); });
+
+    Var x("x"), y("y"), xi("xi"), yi("yi");
+    RDom k(0, size);
+    Func prod("prod"), out("out");
+    prod(x, y) = 0.0f;
+    prod(x, y) += a(x, k) * b(k, y);
+    out(x, y) = prod(x, y);
+
+    // A 2 x 4 tile of vector accumulators, updated by outer products
+    // of a vector of a and a broadcast element of b.
+    out.tile(x, y, xi, yi, 2 * vec, 4).vectorize(xi, vec).unroll(xi).unroll(yi);
+    prod.compute_at(out, x).store_in(memory_type).vectorize(x, vec).unroll(x);
+    prod.update().reorder(x, y, k).vectorize(x, vec).unroll(x);
+    if (unroll_tile) {
+        prod.unroll(y);
+        prod.update().unroll(y);
+    }
+
+    int tiles = 0;
+    out.add_custom_lowering_pass(new CountRegisterTiles(tiles));
+    Buffer<float> result = out.realize({size, size}, t);
+
+    if (tiles != expected_tiles) {
+        printf("Found %d register tiles instead of %d\n", tiles, expected_tiles);
+        return -1;
+    }
+
+    for (int j = 0; j < size; j++) {
+        for (int i = 0; i < size; i++) {
+            float correct = 0.0f;
+            for (int r = 0; r < size; r++) {
+                correct += a(i, r) * b(r, j);
+            }
+            if (result(i, j) != correct) {
+                printf("result(%d, %d) = %f instead of %f\n", i, j, result(i, j), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature()) {
+        printf("[SKIP] Register tiles are only promoted on the CPU.\n");
+        return 0;
+    }
+
+    // An unrolled, vectorized tile of accumulators is promoted
+    // automatically.
+    if (test_matmul(true, MemoryType::Auto, 8) != 0) {
+        return -1;
+    }
+
+    // ... or explicitly.
+    if (test_matmul(true, MemoryType::Register, 8) != 0) {
+        return -1;
+    }
+
+    // If the tile isn't unrolled, the accumulators aren't at constant
+    // coordinates, so they stay in memory.
+    if (test_matmul(false, MemoryType::Auto, 0) != 0) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
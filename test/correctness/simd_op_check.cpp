@@ -47,6 +47,10 @@ public:
         use_wasm_simd128 = target.has_feature(Target::WasmSimd128);
         use_wasm_sat_float_to_int = target.has_feature(Target::WasmSatFloatToInt);
         use_wasm_sign_ext = target.has_feature(Target::WasmSignExt);
+        // LLVM only uses SVE for fixed-width vectors wider than NEON.
+        use_sve = (target.arch == Target::ARM && target.bits == 64 && target.vector_bits >= 256 &&
+                   (target.has_feature(Target::SVE) || target.has_feature(Target::SVE2)));
+        use_rvv = target.arch == Target::RISCV && target.has_feature(Target::RVV);
     }
 
     void add_tests() override {
@@ -54,11 +58,17 @@ public:
         if (target.arch == Target::X86) {
             check_sse_all();
         } else if (target.arch == Target::ARM) {
-            check_neon_all();
+            if (use_sve) {
+                check_sve_all();
+            } else {
+                check_neon_all();
+            }
         } else if (target.arch == Target::POWERPC) {
             check_altivec_all();
         } else if (target.arch == Target::WebAssembly) {
             check_wasm_all();
+        } else if (use_rvv) {
+            check_rvv_all();
         }
     }
 
@@ -523,6 +533,21 @@ public:
             check("vpmaxsq", 8, max(i64_1, i64_2));
             check("vpminsq", 8, min(i64_1, i64_2));
         }
+        // LLVM only knows AVX512-FP16 from LLVM 14.
+        const bool use_avx512_fp16 = use_avx512 && target.has_feature(Target::AVX512_SapphireRapids) &&
+                                     Halide::Internal::get_llvm_version() >= 140;
+        if (target.has_feature(Target::F16C) || use_avx512_fp16) {
+            check("vcvtph2ps", 8, cast(Float(32), in_f16(x)));
+            check("vcvtps2ph", 8, cast(Float(16), f32_1));
+        }
+        if (use_avx512_fp16) {
+            Expr f16_1 = in_f16(x), f16_2 = in_f16(x + 16);
+            check("vaddph*zmm", 32, f16_1 + f16_2);
+            check("vsubph*ymm", 16, f16_1 - f16_2);
+            check("vmulph*zmm", 32, f16_1 * f16_2);
+            check("vdivph*xmm", 8, f16_1 / f16_2);
+            check("vmaxph*zmm", 32, max(f16_1, f16_2));
+        }
         if (use_avx512 && target.has_feature(Target::AVX512_SapphireRapids)) {
             check("vcvtne2ps2bf16*zmm", 32, cast(BFloat(16), f32_1));
             check("vcvtneps2bf16*ymm", 16, cast(BFloat(16), f32_1));
@@ -567,6 +592,22 @@ public:
                 check("vpdpbusds*xmm", 4, saturating_sum(i32(in_i8(4 * x + r)) * in_u8(4 * x + r + 32)));
             }
         }
+        if (!use_avx512 && target.has_feature(Target::AVXVNNI)) {
+            // The VEX-encoded versions of the 256 and 128-bit dot products.
+            {
+                RDom r(0, 2);
+                check("{vex}*vpdpwssd*ymm", 8, sum(i32(in_i16(2 * x + r)) * in_i16(2 * x + r + 32)));
+                check("{vex}*vpdpwssd*xmm", 4, sum(i32(in_i16(2 * x + r)) * in_i16(2 * x + r + 32)));
+                check("{vex}*vpdpwssds*ymm", 8, saturating_sum(i32(in_i16(2 * x + r)) * in_i16(2 * x + r + 32)));
+            }
+            {
+                RDom r(0, 4);
+                check("{vex}*vpdpbusd*ymm", 8, sum(i32(in_u8(4 * x + r)) * in_i8(4 * x + r + 32)));
+                check("{vex}*vpdpbusd*ymm", 8, sum(i32(in_i8(4 * x + r)) * in_u8(4 * x + r + 32)));
+                check("{vex}*vpdpbusd*xmm", 4, sum(i32(in_u8(4 * x + r)) * in_i8(4 * x + r + 32)));
+                check("{vex}*vpdpbusds*ymm", 8, saturating_sum(i32(in_u8(4 * x + r)) * in_i8(4 * x + r + 32)));
+            }
+        }
     }
 
     void check_neon_all() {
@@ -1595,6 +1636,105 @@ public:
         // halide.
     }
 
+    void check_sve_all() {
+        Expr f64_1 = in_f64(x), f64_2 = in_f64(x + 16);
+        Expr f32_1 = in_f32(x), f32_2 = in_f32(x + 16);
+        Expr i8_1 = in_i8(x), i8_2 = in_i8(x + 16);
+        Expr u8_1 = in_u8(x), u8_2 = in_u8(x + 16);
+        Expr i16_1 = in_i16(x), i16_2 = in_i16(x + 16);
+        Expr u16_1 = in_u16(x), u16_2 = in_u16(x + 16);
+        Expr i32_1 = in_i32(x), i32_2 = in_i32(x + 16);
+        Expr u32_1 = in_u32(x), u32_2 = in_u32(x + 16);
+
+        // The number of lanes of each width in one SVE register.
+        const int b = target.vector_bits / 8;
+        const int h = target.vector_bits / 16;
+        const int s = target.vector_bits / 32;
+        const int d = target.vector_bits / 64;
+
+        for (int w = 1; w <= 2; w++) {
+            // Vectors as wide as the SVE registers should use them.
+            check("add*z*.b", b * w, i8_1 + i8_2);
+            check("sub*z*.h", h * w, u16_1 - u16_2);
+            check("mul*z*.s", s * w, i32_1 * i32_2);
+            check("smax*z*.s", s * w, max(i32_1, i32_2));
+            check("umin*z*.b", b * w, min(u8_1, u8_2));
+            check("smin*z*.h", h * w, min(i16_1, i16_2));
+            check("umax*z*.s", s * w, max(u32_1, u32_2));
+            check("fadd*z*.s", s * w, f32_1 + f32_2);
+            check("fmul*z*.d", d * w, f64_1 * f64_2);
+            check("fmaxnm*z*.s", s * w, max(f32_1, f32_2));
+
+            check("ld1w", s * w, f32_1 + 1);
+            check("st1d", d * w, f64_1 + 1);
+
+            // Gathers from computed indices, and strided loads with a
+            // stride too large for shuffles of dense loads.
+            check("ld1w*[x*, z", s * w, in_f32(in_u8(x)));
+            check("ld1w*[x*, z", s * w, in_i32(in_u16(x) % 512));
+            check("ld1d*[x*, z", d * w, in_f64(in_u8(x)));
+            check("ld1w*[x*, z", s * w, in_f32(x * 5));
+            check("ld1d*[x*, z", d * w, in_i64(x * 7));
+        }
+    }
+
+    void check_rvv_all() {
+        Expr i8_1 = in_i8(x), i8_2 = in_i8(x + 16);
+        Expr u8_1 = in_u8(x), u8_2 = in_u8(x + 16);
+        Expr i16_1 = in_i16(x), i16_2 = in_i16(x + 16), i16_3 = in_i16(x + 32);
+        Expr u16_1 = in_u16(x), u16_2 = in_u16(x + 16), u16_3 = in_u16(x + 32);
+        Expr i32_1 = in_i32(x), i32_2 = in_i32(x + 16);
+        Expr u32_1 = in_u32(x), u32_2 = in_u32(x + 16);
+
+        // The number of lanes of each width in one RVV register.
+        const int vlen = target.vector_bits != 0 ? target.vector_bits : 128;
+        const int b = vlen / 8;
+        const int h = vlen / 16;
+        const int s = vlen / 32;
+
+        // Use register groups of one and two registers (LMUL 1 and 2)
+        // for the widest operand.
+        for (int w = 1; w <= 2; w++) {
+            // VSADD, VSADDU, VSSUB, VSSUBU - Saturating add and subtract
+            check("vsadd.v", b * w, i8_sat(i16(i8_1) + i16(i8_2)));
+            check("vsaddu.v", b * w, u8_sat(u16(u8_1) + u16(u8_2)));
+            check("vssub.v", h * w, i16_sat(i32(i16_1) - i32(i16_2)));
+            check("vssubu.v", h * w, u16(max(i32(u16_1) - i32(u16_2), 0)));
+
+            // VAADD, VAADDU - Averaging add
+            check("vaadd.v", s * w, i32((i64(i32_1) + i64(i32_2) + 1) / 2));
+            check("vaaddu.v", b * w, u8((u16(u8_1) + u16(u8_2) + 1) / 2));
+
+            // VSMUL - Fractional multiply with rounding and saturation
+            check("vsmul.v", h * w, i16_sat((i32(i16_1) * i32(i16_2) + (1 << 14)) >> 15));
+
+            // VSSRA, VSSRL - Scaling shift right
+            check("vssra.v", h * w, i16((i32(i16_1) + 8) >> 4));
+            check("vssrl.v", s * w, u32((u64(u32_1) + 8) >> 4));
+
+            // VWADD, VWADDU, VWSUB, VWSUBU - Widening add and subtract
+            check("vwadd.v", h * w, i32(i16_1) + i32(i16_2));
+            check("vwaddu.v", b * w, u16(u8_1) + u16(u8_2));
+            check("vwsub.v", b * w, i16(i8_1) - i16(i8_2));
+            check("vwsubu.v", h * w, i32(u16_1) - i32(u16_2));
+
+            // VWMUL, VWMULU, VWMULSU - Widening multiply
+            check("vwmul.v", h * w, i32(i16_1) * i32(i16_2));
+            check("vwmulu.v", b * w, u16(u8_1) * u16(u8_2));
+            check("vwmulsu.v", b * w, i16(i8_1) * i16(u8_2));
+
+            // VWMACC, VWMACCU - Widening multiply-add
+            check("vwmacc.v", b * w, i16_3 + i16(i8_1) * i16(i8_2));
+            check("vwmaccu.v", b * w, u16_3 + u16(u8_1) * u16(u8_2));
+
+            // VNCLIP, VNCLIPU - Saturating narrowing shift right
+            check("vnclip.w", b * w, i8_sat(i16_1));
+            check("vnclipu.w", b * w, u8_sat(u16_1));
+            check("vnclip.w", h * w, i16_sat((i32_1 + 8) >> 4));
+            check("vnclipu.w", h * w, u16_sat((u32_1 + 128) >> 8));
+        }
+    }
+
     void check_altivec_all() {
         Expr f32_1 = in_f32(x), f32_2 = in_f32(x + 16), f32_3 = in_f32(x + 32);
         Expr f64_1 = in_f64(x), f64_2 = in_f64(x + 16), f64_3 = in_f64(x + 32);
@@ -2242,6 +2382,8 @@ private:
     bool use_avx{false};
     bool use_power_arch_2_07{false};
     bool use_sse41{false};
+    bool use_sve{false};
+    bool use_rvv{false};
     bool use_sse42{false};
     bool use_ssse3{false};
     bool use_vsx{false};
@@ -80,14 +80,16 @@ public:
         bool can_run_the_code =
             (target.arch == host_target.arch &&
              target.bits == host_target.bits &&
-             target.os == host_target.os);
+             target.os == host_target.os &&
+             target.vector_bits == host_target.vector_bits);
         // A bunch of feature flags also need to match between the
         // compiled code and the host in order to run the code.
         for (Target::Feature f : {Target::SSE41, Target::AVX,
-                                  Target::AVX2, Target::AVX512,
+                                  Target::AVX2, Target::AVX512, Target::AVXVNNI,
                                   Target::FMA, Target::FMA4, Target::F16C,
                                   Target::VSX, Target::POWER_ARCH_2_07,
                                   Target::ARMv7s, Target::NoNEON,
+                                  Target::SVE, Target::SVE2, Target::RVV,
                                   Target::WasmSimd128}) {
             if (target.has_feature(f) != host_target.has_feature(f)) {
                 can_run_the_code = false;
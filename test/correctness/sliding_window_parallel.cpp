@@ -0,0 +1,106 @@
+#include "Halide.h"
+
+#include <atomic>
+#include <stdio.h>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+std::atomic<int> count;
+extern "C" DLLEXPORT int call_counter(int x, int y) {
+    count++;
+    return x + y;
+}
+HalideExtern_2(int, call_counter, int, int);
+
+int main(int argc, char **argv) {
+    Var x, y, yo, yi;
+
+    // A stencil stored at root but computed within a parallel loop
+    // gets storage per parallel task, and slides within each task.
+    {
+        count = 0;
+        Func f, g;
+
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y - 1) + f(x, y) + f(x, y + 1);
+
+        g.split(y, yo, yi, 8).parallel(yo);
+        f.store_root().compute_at(g, yi);
+
+        Buffer<int> im = g.realize({16, 64});
+
+        // Each of the 8 tasks computes its 8 rows of f plus two rows
+        // of warm-up.
+        int correct = 16 * 8 * (8 + 2);
+        if (count != correct) {
+            printf("f was called %d times instead of %d times\n", count.load(), correct);
+            return -1;
+        }
+
+        im.for_each_element([&](int x, int y) {
+            if (im(x, y) != 3 * (x + y)) {
+                printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), 3 * (x + y));
+                exit(-1);
+            }
+        });
+    }
+
+    // A chain of sliding windows within parallel tasks.
+    {
+        count = 0;
+        Func f, g, h;
+
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y - 1) + f(x, y + 1);
+        h(x, y) = g(x, y - 1) + g(x, y + 1);
+
+        h.split(y, yo, yi, 16).parallel(yo);
+        g.store_root().compute_at(h, yi);
+        f.store_root().compute_at(h, yi);
+
+        Buffer<int> im = h.realize({16, 64});
+
+        int correct = 16 * 4 * (16 + 4);
+        if (count != correct) {
+            printf("f was called %d times instead of %d times\n", count.load(), correct);
+            return -1;
+        }
+
+        im.for_each_element([&](int x, int y) {
+            if (im(x, y) != 4 * (x + y)) {
+                printf("im(%d, %d) = %d instead of %d\n", x, y, im(x, y), 4 * (x + y));
+                exit(-1);
+            }
+        });
+    }
+
+    // If the compute_at loop is itself parallel there's nothing left
+    // to slide over, but the schedule is still legal.
+    {
+        count = 0;
+        Func f, g;
+
+        f(x, y) = call_counter(x, y);
+        g(x, y) = f(x, y - 1) + f(x, y + 1);
+
+        g.parallel(y);
+        f.store_root().compute_at(g, y);
+
+        Buffer<int> im = g.realize({16, 64});
+
+        int correct = 16 * 64 * 3;
+        if (count != correct) {
+            printf("f was called %d times instead of %d times\n", count.load(), correct);
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
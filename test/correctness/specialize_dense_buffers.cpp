@@ -0,0 +1,132 @@
+#include "Halide.h"
+
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Count the stores in the final lowered Stmt.
+class CountStores : public IRMutator {
+    int &count;
+
+    using IRMutator::visit;
+
+    Stmt visit(const Store *op) override {
+        count++;
+        return IRMutator::visit(op);
+    }
+
+public:
+    CountStores(int &count)
+        : count(count) {
+    }
+};
+
+int check(const Buffer<float> &in, Buffer<float> out) {
+    for (int y = out.dim(1).min(); y <= out.dim(1).max(); y++) {
+        for (int x = out.dim(0).min(); x <= out.dim(0).max(); x++) {
+            float correct = in(x, y) * 2 + 1;
+            if (out(x, y) != correct) {
+                printf("out(%d, %d) = %f instead of %f\n", x, y, out(x, y), correct);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Target t = get_jit_target_from_environment();
+    if (t.has_gpu_feature()) {
+        printf("[SKIP] Dense buffer specialization only applies to CPU targets.\n");
+        return 0;
+    }
+
+    ImageParam in(Float(32), 2);
+    // Allow any innermost stride, so that the fast path has to check it.
+    in.dim(0).set_stride(Expr());
+    Func f;
+    Var x, y;
+    f(x, y) = in(x, y) * 2 + 1;
+    f.vectorize(x, t.natural_vector_size<float>(), TailStrategy::GuardWithIf);
+
+    // With the feature, the pipeline is multi-versioned on entry, so
+    // it contains more stores. The fast version may have fewer than the
+    // fallback, because it has no loop tails.
+    int plain_stores = 0, dense_stores = 0;
+    f.add_custom_lowering_pass(new CountStores(plain_stores));
+    f.compile_jit(t);
+    f.clear_custom_lowering_passes();
+
+    Target dense = t.with_feature(Target::SpecializeDenseBuffers);
+    f.add_custom_lowering_pass(new CountStores(dense_stores));
+    f.compile_jit(dense);
+    f.clear_custom_lowering_passes();
+
+    if (plain_stores == 0 || dense_stores <= plain_stores) {
+        printf("Found %d stores with dense buffer specialization, and %d without\n",
+               dense_stores, plain_stores);
+        return -1;
+    }
+
+    // Both versions must be correct. Storage for the input has room
+    // for a few different kinds of unfriendly buffers.
+    Buffer<float> storage(200, 64);
+    storage.for_each_element([&](int x, int y) {
+        storage(x, y) = x * 0.5f + y;
+    });
+
+    // Dense and aligned
+    {
+        Buffer<float> input(storage.get()->cropped(0, 0, 128));
+        in.set(input);
+        Buffer<float> out = f.realize({128, 64}, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    // Sizes that aren't a multiple of the vector width
+    {
+        Buffer<float> input(storage.get()->cropped(0, 0, 37));
+        in.set(input);
+        Buffer<float> out = f.realize({37, 5}, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    // A misaligned min and host pointer
+    {
+        Buffer<float> input(storage.get()->cropped(0, 3, 128));
+        in.set(input);
+        Buffer<float> out(128, 64);
+        out.set_min(3, 0);
+        f.realize(out, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    // A misaligned host pointer with an aligned min
+    {
+        Buffer<float> input(storage.data() + 1, 128, 64);
+        in.set(input);
+        Buffer<float> out = f.realize({128, 64}, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    // An odd row stride
+    {
+        Buffer<float> input(storage.data(), 128, 64);
+        input.raw_buffer()->dim[1].stride = 131;
+        in.set(input);
+        Buffer<float> out = f.realize({128, 32}, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    // A non-unit innermost stride
+    {
+        Buffer<float> input(storage.get()->transposed(0, 1));
+        in.set(input);
+        Buffer<float> out = f.realize({64, 64}, dense);
+        if (check(input, out) != 0) return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -195,6 +195,38 @@ int main(int argc, char **argv) {
         return -1;
     }
 
+    // SVE is as wide as we're told it is
+    t1 = Target("arm-64-linux-sve2-vector_bits_256");
+    ts = t1.to_string();
+    if (t1.vector_bits != 256 || ts != "arm-64-linux-sve2-vector_bits_256") {
+        printf("vector_bits to_string failure: %s\n", ts.c_str());
+        return -1;
+    }
+    if (t1.natural_vector_size<uint8_t>() != 32 ||
+        t1.natural_vector_size<float>() != 8 ||
+        t1.natural_vector_size<double>() != 4) {
+        printf("natural_vector_size failure\n");
+        return -1;
+    }
+    if (t1.without_feature(Target::SVE2).natural_vector_size<float>() != 4) {
+        printf("natural_vector_size failure\n");
+        return -1;
+    }
+    // So is RVV
+    t1 = Target("riscv-64-linux-rvv-vector_bits_512");
+    if (t1.natural_vector_size<uint16_t>() != 32 ||
+        t1.without_feature(Target::RVV).natural_vector_size<uint16_t>() != 8) {
+        printf("natural_vector_size failure\n");
+        return -1;
+    }
+    for (const char *bad : {"arm-64-linux-sve-vector_bits_100", "arm-64-linux-sve-vector_bits_0",
+                            "arm-64-linux-sve-vector_bits_4096", "arm-64-linux-sve-vector_bits_"}) {
+        if (Target::validate_target_string(bad)) {
+            printf("validate_target_string failure: %s\n", bad);
+            return -1;
+        }
+    }
+
     t1 = Target("x86-64-linux-trace_all");
     ts = t1.to_string();
     if (!t1.features_all_of({Target::TraceLoads, Target::TraceStores, Target::TraceRealizations})) {
@@ -0,0 +1,103 @@
+#include "Halide.h"
+
+#include <stdio.h>
+#include <vector>
+
+using namespace Halide;
+
+#ifdef _WIN32
+#define DLLEXPORT __declspec(dllexport)
+#else
+#define DLLEXPORT
+#endif
+
+std::vector<std::pair<int, int>> visits;
+extern "C" DLLEXPORT int record_visit(int x, int y) {
+    visits.emplace_back(x, y);
+    return 0;
+}
+HalideExtern_2(int, record_visit, int, int);
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y"), xo("xo"), yo("yo"), xi("xi"), yi("yi");
+
+    // Leaf tiles are visited in Z order.
+    {
+        Func f("f");
+        f(x, y) = record_visit(x, y);
+        f.tile_recursive(x, y, xo, yo, xi, yi, 4, 4, 3);
+
+        const int size = 32;
+        visits.clear();
+        f.realize({size, size});
+
+        if ((int)visits.size() != size * size) {
+            printf("%d points computed instead of %d\n", (int)visits.size(), size * size);
+            return -1;
+        }
+        for (int i = 0; i < size * size; i++) {
+            // Deinterleave the bits of the leaf tile index.
+            int tile = i / 16, tx = 0, ty = 0;
+            for (int b = 0; b < 3; b++) {
+                tx |= ((tile >> (2 * b)) & 1) << b;
+                ty |= ((tile >> (2 * b + 1)) & 1) << b;
+            }
+            int correct_x = tx * 4 + (i % 4);
+            int correct_y = ty * 4 + (i % 16) / 4;
+            if (visits[i].first != correct_x || visits[i].second != correct_y) {
+                printf("Visit %d was to (%d, %d) instead of (%d, %d)\n",
+                       i, visits[i].first, visits[i].second, correct_x, correct_y);
+                return -1;
+            }
+        }
+    }
+
+    // Sizes that aren't a multiple of the leaf or a power of two, with
+    // the leaf vectorized and unrolled, and a producer per leaf tile.
+    {
+        Func f("f"), g("g");
+        g(x, y) = x + y * 1000;
+        f(x, y) = g(x, y) * 2;
+        f.tile_recursive(x, y, xo, yo, xi, yi, 8, 4, 2).vectorize(xi).unroll(yi).parallel(y);
+        g.compute_at(f, xo).vectorize(x, 8);
+
+        for (int w : {8, 37, 100}) {
+            for (int h : {4, 21, 77}) {
+                Buffer<int> out = f.realize({w, h});
+                for (int j = 0; j < h; j++) {
+                    for (int i = 0; i < w; i++) {
+                        int correct = (i + j * 1000) * 2;
+                        if (out(i, j) != correct) {
+                            printf("%dx%d: out(%d, %d) = %d instead of %d\n",
+                                   w, h, i, j, out(i, j), correct);
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // An update stage over an RDom.
+    {
+        Func f("f");
+        RDom r(0, 50, 0, 30);
+        RVar rxo("rxo"), ryo("ryo"), rxi("rxi"), ryi("ryi");
+        f(x, y) = 0;
+        f(r.x, r.y) += r.x * r.y;
+        f.update().tile_recursive(r.x, r.y, rxo, ryo, rxi, ryi, 4, 4, 3);
+
+        Buffer<int> out = f.realize({50, 30});
+        for (int j = 0; j < 30; j++) {
+            for (int i = 0; i < 50; i++) {
+                if (out(i, j) != i * j) {
+                    printf("out(%d, %d) = %d instead of %d\n", i, j, out(i, j), i * j);
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
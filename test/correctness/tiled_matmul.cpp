@@ -212,12 +212,238 @@ bool matmul_bf16() {
     return true;
 }
 
+// Count the AMX tile operations in the lowered Stmt.
+class CountTileOps : public Internal::IRMutator {
+    using Internal::IRMutator::visit;
+
+    Expr visit(const Internal::Call *op) override {
+        if (op->name == "tile_matmul") {
+            matmuls++;
+        } else if (op->name == "tile_store") {
+            stores++;
+        }
+        return Internal::IRMutator::visit(op);
+    }
+
+public:
+    int matmuls = 0;
+    int stores = 0;
+};
+
+bool matmul_bias_requant(bool lower_only = false) {
+    // A tile of 4 rows, with a bias and requantization to uint8 fused
+    // into the tile operations. If lower_only is set, just check that it
+    // lowers to tile operations, which doesn't need AMX hardware.
+    constexpr int row = 8;
+    constexpr int col = 16;
+    constexpr int acc = 32;
+
+    Buffer<int8_t> A_buf(acc, row);
+    Buffer<int8_t> B_buf(4, col, acc / 4);
+    Buffer<int32_t> bias(col);
+
+    Var x("x"), y("y");
+    RDom r(0, acc);
+
+    Func mm("matmul");
+    mm(x, y) = bias(x);
+    mm(x, y) += cast<int32_t>(A_buf(r, y)) * cast<int32_t>(B_buf(r % 4, x, r / 4));
+
+    Func requant("requant");
+    requant(x, y) = saturating_cast<uint8_t>((mm(x, y) >> 6) + 128);
+
+    constexpr int tile_x = 8;
+    constexpr int tile_y = 4;
+    constexpr int tile_r = 4;
+
+    Var rxi("rxi"), ryi("ryi");
+    RVar rri("rri"), rro("rro");
+
+    mm.compute_at(requant, x)
+        .store_in(MemoryType::AMXTile)
+        .update()
+        .tile(x, y, rxi, ryi, tile_x, tile_y, TailStrategy::GuardWithIf)
+        .split(r, rro, rri, tile_r)
+        .reorder(rri, rxi, ryi, rro, x, y)
+        .atomic()
+        .vectorize(rri)
+        .vectorize(rxi)
+        .vectorize(ryi);
+
+    Var ixi("ixi"), iyi("iyi");
+    mm.compute_at(requant, x)
+        .tile(x, y, ixi, iyi, tile_x, tile_y)
+        .vectorize(ixi)
+        .vectorize(iyi);
+
+    Var rqxi("rqxi"), rqyi("rqyi");
+    requant
+        .tile(x, y, rqxi, rqyi, tile_x, tile_y)
+        .vectorize(rqxi)
+        .vectorize(rqyi);
+
+    if (lower_only) {
+        // ExtractTileOperations only warns when it can't use AMX, so
+        // count the tile operations it made.
+        CountTileOps *counter = new CountTileOps;
+        requant.add_custom_lowering_pass(counter);
+        requant.compile_to_module({}, "requant", Target("x86-64-linux-avx512_sapphirerapids"));
+        if (counter->matmuls == 0 || counter->stores == 0) {
+            std::cerr << "Expected the bias and requantization to be fused into tile operations, but found "
+                      << counter->matmuls << " tile_matmul and " << counter->stores << " tile_store calls\n";
+            return false;
+        }
+        return true;
+    }
+
+    fill_buffer_a(A_buf, row, acc);
+    fill_buffer_b(B_buf, col, acc);
+    for (int i = 0; i < col; i++) {
+        bias(i) = rand() % 2048 - 1024;
+    }
+
+    Buffer<uint8_t> out(col, row);
+
+    requant.realize(out);
+
+    for (int j = 0; j < row; ++j) {
+        for (int i = 0; i < col; ++i) {
+            int32_t val = bias(i);
+            for (int k = 0; k < acc; ++k) {
+                val += static_cast<int32_t>(A_buf(k, j)) * static_cast<int32_t>(B_buf(k % 4, i, k / 4));
+            }
+            val = std::min(std::max((val >> 6) + 128, 0), 255);
+            if (val != out(i, j)) {
+                std::cerr << "Invalid result at " << i << ", " << j << "\n"
+                          << (int)out(i, j) << " != " << val << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+class CountWarnings : public CompileTimeErrorReporter {
+public:
+    int warnings = 0;
+
+    void warning(const char *msg) override {
+        warnings++;
+    }
+
+    void error(const char *msg) override {
+        printf("%s\n", msg);
+        exit(-1);
+    }
+};
+
+bool matmul_fallback() {
+    // The lhs is transposed, which AMX can't load, so the tile should be
+    // computed with ordinary vector instructions after a warning.
+    constexpr int row = 16;
+    constexpr int col = 16;
+    constexpr int acc = 16;
+
+    Buffer<int8_t> A_buf(row, acc);
+    Buffer<int8_t> B_buf(4, col, acc / 4);
+
+    Var x("x"), y("y");
+    RDom r(0, acc);
+
+    Func mm("matmul");
+    mm(x, y) = cast<int32_t>(0);
+    mm(x, y) += cast<int32_t>(A_buf(y, r)) * cast<int32_t>(B_buf(r % 4, x, r / 4));
+
+    constexpr int tile_x = 8;
+    constexpr int tile_y = 8;
+    constexpr int tile_r = 4;
+
+    Var rxi("rxi"), ryi("ryi");
+    RVar rri("rri"), rro("rro");
+
+    mm.compute_at(mm.in(), x)
+        .store_in(MemoryType::AMXTile)
+        .update()
+        .tile(x, y, rxi, ryi, tile_x, tile_y, TailStrategy::GuardWithIf)
+        .split(r, rro, rri, tile_r)
+        .reorder(rri, rxi, ryi, rro, x, y)
+        .atomic()
+        .vectorize(rri)
+        .vectorize(rxi)
+        .vectorize(ryi);
+
+    Var ixi("ixi"), iyi("iyi");
+    mm.compute_at(mm.in(), x)
+        .tile(x, y, ixi, iyi, tile_x, tile_y)
+        .vectorize(ixi)
+        .vectorize(iyi);
+
+    Var mmxi("mmxi"), mmyi("mmyi");
+    mm.in()
+        .tile(x, y, mmxi, mmyi, tile_x, tile_y)
+        .vectorize(mmxi)
+        .vectorize(mmyi);
+
+    Func result = mm.in();
+
+    for (int k = 0; k < acc; k++) {
+        for (int j = 0; j < row; j++) {
+            A_buf(j, k) = rand() % 256 - 128;
+        }
+    }
+    fill_buffer_b(B_buf, col, acc);
+
+    CountWarnings reporter;
+    set_custom_compile_time_error_reporter(&reporter);
+    result.compile_jit();
+    set_custom_compile_time_error_reporter(nullptr);
+    if (reporter.warnings == 0) {
+        std::cerr << "Expected a warning that AMX can't be used\n";
+        return false;
+    }
+
+    Buffer<int32_t> out = result.realize({col, row});
+
+    for (int j = 0; j < row; ++j) {
+        for (int i = 0; i < col; ++i) {
+            int32_t val = 0;
+            for (int k = 0; k < acc; ++k) {
+                val += static_cast<int32_t>(A_buf(j, k)) * static_cast<int32_t>(B_buf(k % 4, i, k / 4));
+            }
+            if (val != out(i, j)) {
+                std::cerr << "Invalid result at " << i << ", " << j << "\n"
+                          << out(i, j) << " != " << val << "\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 auto matmul_ss = &matmul<int8_t, int8_t>;
 auto matmul_us = &matmul<uint8_t, int8_t>;
 auto matmul_su = &matmul<int8_t, uint8_t>;
 auto matmul_uu = &matmul<uint8_t, uint8_t>;
 
 int main(int argc, char **argv) {
+    // A tile that can't use AMX instructions falls back to ordinary
+    // vector code on any target.
+    printf("Running AMX matmul fallback\n");
+    if (!matmul_fallback()) {
+        return -1;
+    } else {
+        printf("Success!\n");
+    }
+
+    printf("Lowering AMX matmul with bias and requantization\n");
+    if (!matmul_bias_requant(true)) {
+        return -1;
+    } else {
+        printf("Success!\n");
+    }
+
     Target t = get_jit_target_from_environment();
     if (!t.has_feature(Target::AVX512_SapphireRapids)) {
         printf("[SKIP] No AMX target enabled\n");
@@ -231,6 +457,13 @@ int main(int argc, char **argv) {
         printf("Success!\n");
     }
 
+    printf("Running AMX matmul with bias and requantization\n");
+    if (!matmul_bias_requant()) {
+        return -1;
+    } else {
+        printf("Success!\n");
+    }
+
     // llvm >= 13.0 is required for unsigned and float AMX instructions
     if (Halide::Internal::get_llvm_version() >= 130) {
         printf("Running AMX matmul (signed/unsigned)\n");
@@ -0,0 +1,19 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    Var x, y;
+    Param<int> n;
+
+    Func f, g;
+
+    f(x, y) = x + y;
+    g(x, y) = f(x, y - 1) + f(x, y);
+    // The size of a ring buffer must be known at compile time.
+    f.store_root().compute_at(g, y).async().ring_buffer(n);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -13,7 +13,7 @@ std::mt19937 rng(0);
 
 template<typename T>
 bool test(int w, bool div, bool round_to_zero) {
-    Func f, g, h;
+    Func f, g, h, k, k_ref;
     Var x, y;
 
     size_t bits = sizeof(T) * 8;
@@ -47,6 +47,11 @@ bool test(int w, bool div, bool round_to_zero) {
         }
     }
 
+    // A divisor that is only known at runtime, but doesn't change within
+    // the inner loop. k_ref divides one element at a time.
+    Param<T> divisor;
+    divisor.set((T)(rng() % (num_vals - 1) + min_val));
+
     if (div) {
         if (round_to_zero) {
             // Test div. We'll unroll entirely across y to turn the denominator into a constant.
@@ -57,6 +62,10 @@ bool test(int w, bool div, bool round_to_zero) {
 
             // Version that uses fast_integer_divide
             h(x, y) = Halide::fast_integer_divide_round_to_zero(input(x, y), cast<uint8_t>(y + min_val));
+
+            // Version that divides by a runtime divisor
+            k(x, y) = div_round_to_zero(input(x, y), divisor);
+            k_ref(x, y) = div_round_to_zero(input(x, y), divisor);
         } else {
             // Test div
             f(x, y) = input(x, y) / cast<T>(y + min_val);
@@ -66,6 +75,10 @@ bool test(int w, bool div, bool round_to_zero) {
 
             // Version that uses fast_integer_divide
             h(x, y) = Halide::fast_integer_divide(input(x, y), cast<uint8_t>(y + min_val));
+
+            // Version that divides by a runtime divisor
+            k(x, y) = input(x, y) / divisor;
+            k_ref(x, y) = input(x, y) / divisor;
         }
     } else {
         // Test mod
@@ -76,20 +89,28 @@ bool test(int w, bool div, bool round_to_zero) {
 
         // Version that uses fast_integer_modulo
         h(x, y) = Halide::fast_integer_modulo(input(x, y), cast<uint8_t>(y + min_val));
+
+        // Version that divides by a runtime divisor
+        k(x, y) = input(x, y) % divisor;
+        k_ref(x, y) = input(x, y) % divisor;
     }
 
     // Try dividing by all the known constants using vectors
     f.bound(y, 0, num_vals).bound(x, 0, input.width()).unroll(y);
     h.bound(x, 0, input.width());
+    k.bound(x, 0, input.width());
     if (w > 1) {
         f.vectorize(x);
         h.vectorize(x);
+        k.vectorize(x);
     }
     Target t = get_jit_target_from_environment();
     t.set_feature(Target::DisableLLVMLoopOpt);
     f.compile_jit(t);
     g.compile_jit(t);
     h.compile_jit(t);
+    k.compile_jit(t);
+    k_ref.compile_jit(t);
 
     Buffer<T> correct = g.realize({input.width(), num_vals});
     double t_correct = benchmark([&]() { g.realize(correct); });
@@ -100,10 +121,26 @@ bool test(int w, bool div, bool round_to_zero) {
     Buffer<T> fast_dynamic = h.realize({input.width(), num_vals});
     double t_fast_dynamic = benchmark([&]() { h.realize(fast_dynamic); });
 
-    printf("%6.3f                  %6.3f\n", t_correct / t_fast, t_correct / t_fast_dynamic);
+    Buffer<T> correct_runtime = k_ref.realize({input.width(), num_vals});
+    double t_correct_runtime = benchmark([&]() { k_ref.realize(correct_runtime); });
+
+    Buffer<T> fast_runtime = k.realize({input.width(), num_vals});
+    double t_fast_runtime = benchmark([&]() { k.realize(fast_runtime); });
+
+    printf("%6.3f                  %6.3f                    %6.3f\n",
+           t_correct / t_fast, t_correct / t_fast_dynamic, t_correct_runtime / t_fast_runtime);
 
     for (int y = 0; y < num_vals; y++) {
         for (int x = 0; x < input.width(); x++) {
+            if (fast_runtime(x, y) != correct_runtime(x, y)) {
+                printf("fast_runtime(%d, %d) = %lld instead of %lld (%lld/%lld)\n",
+                       x, y,
+                       (long long int)fast_runtime(x, y),
+                       (long long int)correct_runtime(x, y),
+                       (long long int)input(x, y),
+                       (long long int)divisor.get());
+                return false;
+            }
             if (fast(x, y) != correct(x, y)) {
                 printf("fast(%d, %d) = %lld instead of %lld (%lld/%d)\n",
                        x, y,
@@ -143,7 +180,7 @@ int main(int argc, char **argv) {
             printf("modulus:\n");
             break;
         }
-        printf("type            const-divisor speed-up  runtime-divisor speed-up\n");
+        printf("type            const-divisor speed-up  runtime-divisor speed-up  invariant-divisor speed-up\n");
 
         // Scalar
         success = success && test<int32_t>(1, i == 0, i == 1);
@@ -6,37 +6,42 @@
 using namespace Halide;
 using namespace Halide::Tools;
 
-void test_deinterleave() {
+// A distinct value for each channel
+uint8_t channel_value(int c) {
+    return (uint8_t)(c * 85);
+}
+
+void test_deinterleave(int channels) {
     ImageParam src(UInt(8), 3);
     Func dst;
     Var x, y, c;
 
     dst(x, y, c) = src(x, y, c);
 
-    src.dim(0).set_stride(3).dim(2).set_stride(1).set_bounds(0, 3);
+    src.dim(0).set_stride(channels).dim(2).set_stride(1).set_bounds(0, channels);
 
     // This is the default format for Halide, but made explicit for illustration.
     dst.output_buffer()
         .dim(0)
         .set_stride(1)
         .dim(2)
-        .set_extent(3);
+        .set_extent(channels);
 
+    // Use the native vector width, so that the strided loads can use
+    // the target's deinterleaving shuffles.
     dst.reorder(c, x, y).unroll(c);
-    dst.vectorize(x, 16);
+    dst.vectorize(x, get_jit_target_from_environment().natural_vector_size<uint8_t>());
 
-    // Allocate two 16 megapixel, 3 channel, 8-bit images -- input and output
+    // Allocate two 16 megapixel, 8-bit images -- input and output
 
-    // Setup src to be RGB interleaved, with no extra padding between channels or rows.
-    Buffer<uint8_t> src_image = Buffer<uint8_t>::make_interleaved(1 << 12, 1 << 12, 3);
+    // Setup src to be interleaved, with no extra padding between channels or rows.
+    Buffer<uint8_t> src_image = Buffer<uint8_t>::make_interleaved(1 << 12, 1 << 12, channels);
 
     // Setup dst to be planar, with no extra padding between channels or rows.
-    Buffer<uint8_t> dst_image(1 << 12, 1 << 12, 3);
+    Buffer<uint8_t> dst_image(1 << 12, 1 << 12, channels);
 
-    src_image.for_each_element([&](int x, int y) {
-        src_image(x, y, 0) = 0;
-        src_image(x, y, 1) = 128;
-        src_image(x, y, 2) = 255;
+    src_image.for_each_element([&](int x, int y, int c) {
+        src_image(x, y, c) = channel_value(c);
     });
     dst_image.fill(0);
 
@@ -51,17 +56,15 @@ void test_deinterleave() {
         dst.realize(dst_image);
     });
 
-    printf("Interleaved to planar bandwidth %.3e byte/s.\n",
-           dst_image.number_of_elements() / t1);
+    printf("Interleaved to planar bandwidth (%d channels) %.3e byte/s.\n",
+           channels, dst_image.number_of_elements() / t1);
 
-    dst_image.for_each_element([&](int x, int y) {
-        assert(dst_image(x, y, 0) == 0);
-        assert(dst_image(x, y, 1) == 128);
-        assert(dst_image(x, y, 2) == 255);
+    dst_image.for_each_element([&](int x, int y, int c) {
+        assert(dst_image(x, y, c) == channel_value(c));
     });
 
     // Setup a semi-planar output case.
-    dst_image = Buffer<uint8_t>(1 << 12, 3, 1 << 12);
+    dst_image = Buffer<uint8_t>(1 << 12, channels, 1 << 12);
     dst_image.transpose(1, 2);
     dst_image.fill(0);
 
@@ -69,14 +72,12 @@ void test_deinterleave() {
         dst.realize(dst_image);
     });
 
-    dst_image.for_each_element([&](int x, int y) {
-        assert(dst_image(x, y, 0) == 0);
-        assert(dst_image(x, y, 1) == 128);
-        assert(dst_image(x, y, 2) == 255);
+    dst_image.for_each_element([&](int x, int y, int c) {
+        assert(dst_image(x, y, c) == channel_value(c));
     });
 
-    printf("Interleaved to semi-planar bandwidth %.3e byte/s.\n",
-           dst_image.number_of_elements() / t2);
+    printf("Interleaved to semi-planar bandwidth (%d channels) %.3e byte/s.\n",
+           channels, dst_image.number_of_elements() / t2);
 }
 
 void test_interleave(bool fast) {
@@ -150,7 +151,8 @@ int main(int argc, char **argv) {
         return 0;
     }
 
-    test_deinterleave();
+    test_deinterleave(3);
+    test_deinterleave(4);
     test_interleave(false);
     test_interleave(true);
     printf("Success!\n");